@@ -0,0 +1,92 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Channel.h"
+#include "EventLoop.h"
+#include "Logger.h"
+
+// Poller后端对比：N对socketpair组成环，M个令牌在环上传递，统计每秒处理的事件数
+// 用法: poller_bench [pairs=1000] [tokens=100] [seconds=3]
+namespace {
+struct Ring {
+    std::vector<int> readFds;
+    std::vector<int> writeFds;
+    std::vector<std::unique_ptr<Channel>> channels;
+    long long events = 0;
+};
+
+double runOnce(const char* backend, int pairs, int tokens, double seconds) {
+    if (std::string(backend) == "io_uring") {
+        ::setenv("MUDUO_USE_IO_URING", "1", 1);
+    } else {
+        ::unsetenv("MUDUO_USE_IO_URING");
+    }
+
+    EventLoop loop;
+    Ring ring;
+    for (int i = 0; i < pairs; ++i) {
+        int sv[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) < 0) {
+            std::cerr << "socketpair failed, try a smaller pair count" << std::endl;
+            ::exit(1);
+        }
+        ring.readFds.push_back(sv[0]);
+        ring.writeFds.push_back(sv[1]);
+    }
+    for (int i = 0; i < pairs; ++i) {
+        ring.channels.emplace_back(new Channel(&loop, ring.readFds[i]));
+        Channel* channel = ring.channels.back().get();
+        int next = ring.writeFds[(i + 1) % pairs];
+        int fd = ring.readFds[i];
+        channel->setReadCallback([&ring, fd, next](TimeStamp) {
+            char buf[64];
+            ssize_t n = ::read(fd, buf, sizeof buf);
+            if (n > 0) {
+                ++ring.events;
+                ::write(next, buf, static_cast<size_t>(n));  // 令牌传递给下一个fd
+            }
+        });
+        channel->enableReading();
+    }
+    for (int i = 0; i < tokens; ++i) {
+        char c = 't';
+        ::write(ring.writeFds[(i * pairs / tokens) % pairs], &c, 1);
+    }
+
+    loop.runAfter(seconds, [&loop]() { loop.quit(); });
+    auto start = std::chrono::steady_clock::now();
+    loop.loop();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto& channel : ring.channels) {
+        channel->disableAll();
+        channel->remove();
+    }
+    for (int i = 0; i < pairs; ++i) {
+        ::close(ring.readFds[i]);
+        ::close(ring.writeFds[i]);
+    }
+    return ring.events / elapsed;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int pairs = argc > 1 ? atoi(argv[1]) : 1000;
+    int tokens = argc > 2 ? atoi(argv[2]) : 100;
+    double seconds = argc > 3 ? atof(argv[3]) : 3.0;
+    Logger::instance().setLogLevel(WARN);  // 关闭每个事件的INFO日志，避免干扰测量
+
+    for (const char* backend : {"epoll", "io_uring"}) {
+        double rate = runOnce(backend, pairs, tokens, seconds);
+        std::cout << backend << ": " << pairs << " pairs, " << tokens << " tokens, " << static_cast<long long>(rate) << " events/s" << std::endl;
+    }
+    return 0;
+}
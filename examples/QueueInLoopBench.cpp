@@ -0,0 +1,60 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "EventLoop.h"
+#include "Logger.h"
+
+// queueInLoop 跨线程投递的竞争测试：1~32个生产者线程向同一个loop投递任务，统计每秒完成的任务数
+// 用法: queue_in_loop_bench [tasks_per_producer=200000]
+namespace {
+double runOnce(EventLoop* loop, int producers, int tasksPerProducer) {
+    std::atomic<long long> done{0};
+    const long long expected = static_cast<long long>(producers) * tasksPerProducer;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([loop, &done, tasksPerProducer]() {
+            for (int i = 0; i < tasksPerProducer; ++i) {
+                loop->queueInLoop([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    while (done.load(std::memory_order_relaxed) < expected) {
+        std::this_thread::yield();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return expected / elapsed;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int tasksPerProducer = argc > 1 ? atoi(argv[1]) : 200000;
+    Logger::instance().setLogLevel(WARN);
+
+    EventLoop* loop = nullptr;
+    std::atomic<bool> ready{false};
+    std::thread loopThread([&]() {
+        EventLoop l;
+        loop = &l;
+        ready = true;
+        l.loop();
+    });
+    while (!ready) {
+        std::this_thread::yield();
+    }
+
+    for (int producers : {1, 2, 4, 8, 16, 32}) {
+        double rate = runOnce(loop, producers, tasksPerProducer);
+        std::cout << producers << " producers: " << static_cast<long long>(rate) << " tasks/s" << std::endl;
+    }
+    loop->quit();
+    loopThread.join();
+    return 0;
+}
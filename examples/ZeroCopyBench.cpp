@@ -0,0 +1,105 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EventLoop.h"
+#include "Logger.h"
+#include "TcpServer.h"
+
+// 大负载发送路径对比（回环）：std::string复制发送、SharedSlice引用发送、SharedSlice零拷贝发送
+// 服务端每次写完后再发一份负载，客户端读到总量后结束，统计吞吐
+// 用法: zerocopy_bench [payloadMB=4] [totalMB=4096] [port=19600]
+namespace {
+enum Mode { kCopy, kShared, kZeroCopy };
+const char* kModeNames[] = {"string copy", "shared slice", "zerocopy"};
+
+void drain(uint16_t port, size_t total) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    while (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::vector<char> buf(1024 * 1024);
+    size_t received = 0;
+    while (received < total) {
+        ssize_t n = ::read(fd, buf.data(), buf.size());
+        if (n <= 0) {
+            break;
+        }
+        received += n;
+    }
+    ::close(fd);
+}
+
+void runOnce(Mode mode, size_t payloadBytes, size_t total, uint16_t port) {
+    std::string content(payloadBytes, 'z');
+    SharedSlice payload(content);
+    size_t sent = 0;
+    bool zeroCopyAtEnd = false;
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress("127.0.0.1", port), "ZeroCopyBench");
+    auto sendNext = [&](const TcpConnectionPtr& conn) {
+        if (sent >= total) {
+            return;
+        }
+        sent += payloadBytes;
+        if (mode == kCopy) {
+            conn->send(content);
+        } else {
+            conn->send(payload);
+        }
+    };
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            if (mode == kZeroCopy) {
+                conn->setZeroCopyThreshold(64 * 1024);
+            }
+            sendNext(conn);
+        } else {
+            loop.quit();
+        }
+    });
+    server.setMessageCallback([](const TcpConnectionPtr&, Buffer* buf, TimeStamp) { buf->retrieveAll(); });
+    server.setWriteCompleteCallback([&](const TcpConnectionPtr& conn) {
+        zeroCopyAtEnd = conn->zeroCopyEnabled();
+        sendNext(conn);
+    });
+    server.start();
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread client(drain, port, total);
+    loop.loop();
+    client.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << kModeNames[mode] << ": " << static_cast<long long>(total / elapsed / (1024 * 1024)) << " MB/s";
+    if (mode == kZeroCopy) {
+        std::cout << (zeroCopyAtEnd ? " (zerocopy active)" : " (kernel copied, fell back to regular send)");
+    }
+    std::cout << std::endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t payloadMB = argc > 1 ? atoi(argv[1]) : 4;
+    size_t totalMB = argc > 2 ? atoi(argv[2]) : 4096;
+    uint16_t port = static_cast<uint16_t>(argc > 3 ? atoi(argv[3]) : 19600);
+    Logger::instance().setLogLevel(WARN);
+
+    for (Mode mode : {kCopy, kShared, kZeroCopy}) {
+        runOnce(mode, payloadMB * 1024 * 1024, totalMB * 1024 * 1024, port++);
+    }
+    return 0;
+}
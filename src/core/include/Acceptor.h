@@ -1,27 +1,45 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "Channel.h"
+#include "InetAddress.h"
 #include "NonCopyable.h"
 #include "Socket.h"
+#include "TimerId.h"
 
 class EventLoop;
-class InetAddress;
 
 class Acceptor : NonCopyable {
 public:
     using NewConnectionCallback = std::function<void(int sockfd, const InetAddress&)>;
+    struct AcceptedSocket {
+        int sockfd;
+        InetAddress peerAddr;
+    };
+    using NewConnectionBatchCallback = std::function<void(const std::vector<AcceptedSocket>&)>;
 
     Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reuseport);
+    // 接管一个已经bind/listen的非阻塞监听socket（如热升级时从旧进程收到的fd）
+    Acceptor(EventLoop* loop, int listenFd);
     ~Acceptor();
     
     // 监听本地端口
     void listen();
+    EventLoop* getLoop() const { return loop_; }
+    int listenFd() const { return acceptSocket_.getSocketFd(); }
     // 判断是否在监听
     bool listenning() const { return listenning_; }
+    // 边沿触发模式（需在listen之前设置）：每次事件循环accept到EAGAIN为止
+    void setEdgeTriggered(bool on) { acceptChannel_.setEdgeTriggered(on); }
+    // 按收包CPU在SO_REUSEPORT组内选择acceptor（需在组内所有socket都listen之后调用）
+    bool setCpuSteering(int groupSize) { return acceptSocket_.setReusePortCpuSteering(groupSize); }
     // 设置新连接的回调函数
     void setNewConnectionCallback(const NewConnectionCallback& cb) { NewConnectionCallback_ = cb; }
+    // 设置批量回调后，一次可读事件accept到的所有连接一起交给上层，不再逐个调用NewConnectionCallback_
+    void setNewConnectionBatchCallback(const NewConnectionBatchCallback& cb) { newConnectionBatchCallback_ = cb; }
 
 private:
     // ==== 核心组件 ====
@@ -31,10 +49,22 @@ private:
 
     // ==== 运行时状态 ====
     bool listenning_;  // 监听状态标志
+    int idleFd_;  // 预留的空闲fd，fd耗尽(EMFILE)时用于接受并立即关闭连接
+    std::vector<AcceptedSocket> batch_;  // 本次事件accept到的连接，复用容量
+    std::shared_ptr<bool> alive_;  // ET续接任务持有其弱引用，Acceptor析构后排队的任务不再访问this
+    TimerId retryTimer_;  // fd耗尽且无法借用预留fd时，暂停监听后恢复的定时器
 
     // ==== 回调接口 ====
     NewConnectionCallback NewConnectionCallback_;  // 新连接到达回调
+    NewConnectionBatchCallback newConnectionBatchCallback_;  // 批量新连接回调
+
+    // ==== 常量配置 ====
+    static const int kMaxAcceptsPerEvent = 256;  // 单次事件最多accept的连接数
+    static constexpr double kAcceptRetryDelay = 0.1;  // fd耗尽时暂停监听的时长（秒）
 
     // ==== 内部方法 ====
     void handleRead();  // 处理可读事件（接受新连接）
+    bool shedConnection();  // fd耗尽时借用idleFd_接受并关闭一个连接，没有预留fd时返回false
+    void pauseAccepting();  // 停止关注监听fd，kAcceptRetryDelay后重试
+    void resumeAccepting();  // 重新打开预留fd并恢复监听
 };
\ No newline at end of file
@@ -3,19 +3,36 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
-#include <vector>
 
-// 网络库底层的缓冲区类型定义
+class SlabPool;
+
+/**
+ * 网络库底层的缓冲区类型定义
+ * 存储可以来自所属EventLoop的SlabPool（TcpConnection的输入缓冲区）：按需分配，
+ * 数据读完后releaseStorage把存储归还池中，空闲连接的缓冲区不占内存。
+ * 池化的Buffer只能在loop线程分配/归还；析构可以在其他线程，剩余的存储经SlabPool::deallocate归还。
+ **/
 class Buffer {
 public:
     static const size_t kCheapPrepend = 8;  // 初始预留的prependabel空间大小
-    static const size_t kInitialSize = 1024;
+    static constexpr size_t kInitialSize = 1024;
+
+    static constexpr size_t kMaxReadHint = 64 * 1024;  // 预读大小上限，更大的消息由暂存区承接
 
-    explicit Buffer(size_t initalSize = kInitialSize) : buffer_(kCheapPrepend + initalSize), readerIndex_(kCheapPrepend), writerIndex_(kCheapPrepend) {}
+    explicit Buffer(size_t initalSize = kInitialSize);
+    // 从pool按需分配存储，构造时不占内存
+    explicit Buffer(SlabPool* pool);
+    ~Buffer();
+    Buffer(const Buffer& other);  // 拷贝得到的Buffer使用堆存储
+    Buffer& operator=(const Buffer& other);
+    Buffer(Buffer&& other) noexcept;
+    Buffer& operator=(Buffer&& other) noexcept;
+    void swap(Buffer& other) noexcept;
 
     size_t readableBytes() const { return writerIndex_ - readerIndex_; }
-    size_t writableBytes() const { return buffer_.size() - writerIndex_; }
+    size_t writableBytes() const { return capacity_ - writerIndex_; }
     size_t prependableBytes() const { return readerIndex_; }
 
     // 返回缓冲区中可读数据的起始地址
@@ -56,22 +73,50 @@ public:
     char* beginWrite() { return begin() + writerIndex_; }
     const char* beginWrite() const { return begin() + writerIndex_; }
 
-    // 从fd上读取数据
-    ssize_t readFd(int fd, int* saveErrno);
+    /**
+     * 从fd上读取数据，单次最多读取maxBytes字节。
+     * 第一块iovec是Buffer的可写空间，读前按readHint_预留，多数读取直接落进Buffer；第二块是暂存区scratch，
+     * 超出部分再追加拷贝。scratch为空时使用线程局部的暂存区；TcpConnection传入所属EventLoop的暂存区。
+     **/
+    ssize_t readFd(int fd, int* saveErrno, size_t maxBytes = SIZE_MAX, char* scratch = nullptr, size_t scratchLen = 0);
+    size_t capacity() const { return capacity_ == kCheapPrepend ? 0 : capacity_; }  // 当前占用的存储大小
+    bool pooled() const { return pool_ != nullptr; }  // 存储是否来自某个loop的SlabPool
+    // 没有可读数据时把存储归还池（或堆），下次写入时再分配
+    void releaseStorage();
+    // 按可读数据重新分配到最小的存储，用于长时间残留少量数据的空闲连接
+    void shrinkToFit();
+
+    // 当前预读大小：连续读到超过它的数据时翻倍，连续小读时减半
+    size_t readHint() const { return readHint_; }
     // 通过fd发送数据
     ssize_t writeFd(int fd, int* saveErrno);
 
 private:
     // ==== 核心数据存储 ====
-    std::vector<char> buffer_;  // 数据缓冲区（核心成员，应置顶）
+    char* buffer_;  // 数据缓冲区（核心成员，应置顶）；没有存储时指向共享的只读占位区
+    size_t capacity_;  // buffer_的大小，没有存储时为kCheapPrepend
+    SlabPool* pool_;  // 为空时使用堆
 
     // ==== 读写位置索引 ====
     size_t readerIndex_;  // 读位置指针（与buffer_强相关）
     size_t writerIndex_;  // 写位置指针
 
+    // ==== 自适应预读 ====
+    size_t readHint_;  // 下次读取前保证的可写空间
+    int overflowReads_;  // 连续超过readHint_的次数
+    int smallReads_;  // 连续不足readHint_/4的次数
+
+    static const int kGrowAfterOverflows = 2;
+    static const int kShrinkAfterSmallReads = 8;
+
     // ==== 内部方法 ====
-    char* begin() { return &*buffer_.begin(); }
-    const char* begin() const { return &*buffer_.begin(); }
+    char* begin() { return buffer_; }
+    const char* begin() const { return buffer_; }
+
+    void adaptReadHint(size_t n);
+    bool hasStorage() const;
+    void reallocate(size_t capacity);  // 换一块至少capacity大小的存储，可读数据搬到kCheapPrepend处
+    void freeStorage();
 
     /**
      * | kCheapPrepend |xxx| reader | writer |                     // xxx标示reader中已读的部分
@@ -79,7 +124,8 @@ private:
      **/
     void makeSpace(size_t len) {
         if (writableBytes() + prependableBytes() < len + kCheapPrepend) {  // 也就是说 len > xxx前面剩余的空间 + writer的部分
-            buffer_.resize(writerIndex_ + len);
+            // 扩容：新存储只拷贝可读部分，容量至少翻倍
+            reallocate(std::max(kCheapPrepend + readableBytes() + len, capacity_ * 2));
         } else {  // 这里说明 len <= xxx + writer 把reader搬到从xxx开始 使得xxx后面是一段连续空间
             size_t readable = readableBytes();  // readable = reader的长度
             // 将当前缓冲区中从readerIndex_到writerIndex_的数据
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NonCopyable.h"
+#include "SharedSlice.h"
+
+class SlabPool;
+
+/**
+ * 由定长slab串成的链式缓冲区，用作TcpConnection的发送缓冲区。
+ *  - append只填满尾部slab再追加新slab，不会像Buffer那样扩容时整体拷贝或搬移已有数据
+ *  - prepend优先使用头部slab前面已读出的空间，不够时在链头挂一个新slab
+ *  - appendShared把SharedSlice作为一段挂在链上，只持有引用不复制，writev直接从共享存储发送
+ *  - writeFd把各段的可读区域组成iovec，一次writev最多IOV_MAX段
+ * 已读完的slab立即归还SlabPool，缓冲区为空时不占用任何slab（链表本身也不分配）。
+ * 只能在所属loop线程使用；析构可以在其他线程（连接可能在其他线程析构），剩余的slab经SlabPool::deallocate归还。
+ **/
+class ChainBuffer : NonCopyable {
+public:
+    static const size_t kSlabSize = 16 * 1024;  // 16KB
+
+    explicit ChainBuffer(SlabPool* pool = nullptr);
+    ~ChainBuffer();
+
+    size_t readableBytes() const { return readable_; }
+    size_t slabCount() const { return slabs_.size() - head_; }
+
+    void append(const char* data, size_t len);
+    void appendShared(const SharedSlice& slice);
+    void prepend(const char* data, size_t len);
+    void retrieve(size_t len);
+    void retrieveAll();
+    std::string retrieveAllAsString();
+    // 头部是共享段时返回其未发送的部分（引用同一存储），否则返回空
+    SharedSlice frontShared() const;
+
+    // 把可读数据写入fd，单次最多maxBytes字节
+    ssize_t writeFd(int fd, int* saveErrno, size_t maxBytes = SIZE_MAX);
+
+private:
+    struct Slab {
+        char* data;
+        size_t readIndex;
+        size_t writeIndex;
+        std::shared_ptr<const std::string> shared;  // 非空时data指向共享负载，不属于池，不可追加
+    };
+
+    char* allocateSlab();
+    void releaseSlab(char* data);
+    void releaseSegment(Slab& slab);
+
+    SlabPool* pool_;
+    std::vector<Slab> slabs_;  // [head_, size)为有效slab；std::deque默认构造就会分配，空闲连接上不划算
+    size_t head_;
+    size_t readable_;
+};
@@ -66,15 +66,16 @@ public:
         update();
     }
 
+    // 触发模式：默认水平触发(LT)，开启后注册为边沿触发(EPOLLET)
+    // 需要在Channel首次注册到Poller之前设置
+    void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
+    bool isEdgeTriggered() const { return edgeTriggered_; }
+
     // 事件状态查询
     bool isNoneEvent() const { return events_ == kNoneEvent; }  // 是否无监听事件
     bool isWriting() const { return events_ & kWriteEvent; }  // 是否监听写事件
     bool isReading() const { return events_ & kReadEvent; }  // 是否监听读事件
 
-    // 用于Poller的索引管理
-    int getIndex() { return index_; }  // 获取在Poller中的索引
-    void setIndex(int idx) { index_ = idx; }  // 设置Poller中的索引
-
     EventLoop* ownerLoop() { return loop_; }  // 获取所属EventLoop
     void remove();  // 从EventLoop移除当前Channel
 private:
@@ -83,7 +84,7 @@ private:
     const int fd_;  // 管理的文件描述符
     int events_;  // 注册监听的事件（EPOLLIN/EPOLLOUT等）
     int revents_;  // Poller返回的实际发生事件
-    int index_;  // 在Poller中的状态索引（如EPOLL_CTL_ADD/MOD）
+    bool edgeTriggered_;  // 是否以边沿触发模式注册
 
     // ==== 资源安全控制 ====
     std::weak_ptr<void> tie_;  // 弱引用绑定，防止回调时Channel被销毁
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "InetAddress.h"
+#include "NonCopyable.h"
+#include "TimerId.h"
+
+class Channel;
+class EventLoop;
+
+/**
+ * 主动发起非阻塞连接：connect返回EINPROGRESS后监听可写事件，用SO_ERROR判断结果。
+ * 失败时按指数退避重试（retryDelay_从初始值翻倍到上限），可设置单次连接超时与最大重试次数。
+ * 连接成功后把sockfd交给NewConnectionCallback，由上层（TcpClient）创建TcpConnection。
+ **/
+class Connector : NonCopyable, public std::enable_shared_from_this<Connector> {
+public:
+    using NewConnectionCallback = std::function<void(int sockfd)>;
+    using ConnectFailedCallback = std::function<void()>;
+
+    Connector(EventLoop* loop, const InetAddress& serverAddr);
+    ~Connector();
+
+    void setNewConnectionCallback(const NewConnectionCallback& cb) { newConnectionCallback_ = cb; }
+    // 重试次数用尽（或不重试时首次失败）后调用
+    void setConnectFailedCallback(const ConnectFailedCallback& cb) { connectFailedCallback_ = cb; }
+    // 退避参数（秒）：首次重试等待initialDelay，此后每次翻倍，不超过maxDelay
+    void setRetryDelay(double initialDelay, double maxDelay) {
+        initRetryDelay_ = initialDelay;
+        maxRetryDelay_ = maxDelay;
+    }
+    // 单次连接的超时（秒），0表示不限，超时按失败处理并进入重试
+    void setConnectTimeout(double seconds) { connectTimeout_ = seconds; }
+    // 最大重试次数，-1表示无限重试
+    void setMaxRetries(int retries) { maxRetries_ = retries; }
+
+    const InetAddress& serverAddress() const { return serverAddr_; }
+
+    void start();  // 可跨线程调用
+    void restart();  // 必须在loop线程调用，重置退避状态后重新连接
+    void stop();  // 可跨线程调用
+
+    static constexpr double kDefaultInitRetryDelay = 0.5;  // 秒
+    static constexpr double kDefaultMaxRetryDelay = 30.0;  // 秒
+
+private:
+    enum State { kDisconnected, kConnecting, kConnected };
+
+    void setState(State s) { state_ = s; }
+    void startInLoop();
+    void stopInLoop();
+    void connect();
+    void connecting(int sockfd);
+    void handleWrite();
+    void handleError();
+    void handleTimeout();
+    void retry(int sockfd);
+    int removeAndResetChannel();
+    void cancelTimers();
+
+    EventLoop* loop_;
+    InetAddress serverAddr_;
+    std::atomic_bool connect_;  // 是否希望保持连接，stop后为false
+    State state_;
+    std::unique_ptr<Channel> channel_;  // 仅在kConnecting期间存在
+
+    double initRetryDelay_;
+    double maxRetryDelay_;
+    double retryDelay_;  // 下一次重试的等待时间
+    double connectTimeout_;
+    int maxRetries_;
+    int retries_;  // 已重试次数
+    TimerId timeoutTimer_;
+    TimerId retryTimer_;
+
+    NewConnectionCallback newConnectionCallback_;
+    ConnectFailedCallback connectFailedCallback_;
+};
+
+using ConnectorPtr = std::shared_ptr<Connector>;
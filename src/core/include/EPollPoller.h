@@ -26,11 +26,15 @@ private:
     // ==== 核心epoll资源 ====
     int epollfd_;  // epoll实例的文件描述符（核心资源首位）
     EventList events_;  // epoll_wait返回的事件缓冲区
+    std::vector<int> dirtyFds_;  // 本轮兴趣事件有变更的fd，epoll_wait前统一提交
+    uint64_t pendingUpdates_;  // 上次提交以来updateChannel的调用次数
 
     // ==== 常量配置 ====
     static const int kInitEventListSize = 16;  // 事件列表初始大小
 
     // ==== 内部方法 ====
     void fillActiveChannels(int numEvents, ChannelList* activeChannels) const;
-    void update(int operation, Channel* channel);
+    void update(int operation, Channel* channel, uint32_t events);
+    void flushUpdates();  // 把dirtyFds_中的变更合并后提交到内核
+    static uint32_t interestOf(const Channel* channel);  // Channel期望在内核中登记的事件
 };
\ No newline at end of file
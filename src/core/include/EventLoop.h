@@ -3,31 +3,98 @@
 #include <atomic>
 #include <functional>
 #include <memory>
-#include <mutex>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "Callbacks.h"
 #include "CurrentThread.h"
+#include "EventLoopMetrics.h"
+#include "MpscQueue.h"
 #include "NonCopyable.h"
 #include "TimeStamp.h"
+#include "TimerId.h"
 
 class Channel;
 class Poller;
+class SlabPool;
+class TimerQueue;
+class TimingWheel;
 
 // 事件循环类 主要包含了两个大模块 Channel Poller(epoll的抽象)
 class EventLoop : NonCopyable {
 public:
     using Functor = std::function<void()>;
+
+    // 忙轮询统计（可在其他线程读取）
+    struct BusyPollStats {
+        uint64_t spinPolls;  // 自旋期间未取到事件的非阻塞poll次数
+        uint64_t spinHits;  // 自旋期间取到事件的次数
+        uint64_t blockingPolls;  // 自旋窗口耗尽后进入内核阻塞等待的次数
+        int64_t spinWindowUs;  // 当前自适应的自旋窗口（微秒）
+    };
+
     EventLoop();
     ~EventLoop();
 
+    // quit()后返回，返回时复位quit_，之后可再次调用loop()；loop()开始前调用的quit()不会丢失，loop()立即返回
     void loop();
     void quit();
 
     TimeStamp pollReturnTime() const { return pollReturnTime_; }
-    void runInLoop(Functor cb);  // 在当前loop中执行
-    void queueInLoop(Functor cb);  // 把上层注册的回调函数cb放入队列中 唤醒loop所在的线程执行cb
+    // 在当前loop中执行
+    template <typename F>
+    void runInLoop(F&& cb) {
+        if (isInLoopThread()) {  // 在当前线程执行回调
+            cb();
+        } else {  // 非当前线程执行回调，唤醒EventLoop所在线程进行回调
+            queueInLoop(std::forward<F>(cb));
+        }
+    }
+    // 把上层注册的回调函数cb放入队列中 唤醒loop所在的线程执行cb
+    // 回调直接存放在带链接字段的任务节点中，每次投递只分配一次内存（不再经过std::function）
+    template <typename F>
+    void queueInLoop(F&& cb) {
+        enqueue(new PendingTask<typename std::decay<F>::type>(std::forward<F>(cb)));
+    }
     void wakeup();  // 通过eventfd唤醒loop对应的线程
 
+    // 定时器接口（线程安全），回调总是在loop所在线程执行
+    TimerId runAt(TimeStamp time, TimerCallback cb);  // 在指定时间执行
+    TimerId runAfter(double delay, TimerCallback cb);  // delay秒后执行（支持小数，精度到微秒）
+    TimerId runEvery(double interval, TimerCallback cb);  // 每隔interval秒执行一次
+    void cancel(TimerId timerId);  // 取消定时器
+
+    /**
+     * 忙轮询：每轮先以timeout=0自旋poll，窗口内没有事件才进入内核阻塞等待，以CPU换取唤醒延迟。
+     * 自旋窗口在[minSpinUs, maxSpinUs]之间按观测到的事件间隔自适应：事件密集时扩大，空闲时缩小。
+     * maxSpinUs为0时关闭（默认）。需在loop线程中或loop()开始前调用，如EventLoopThreadPool的ThreadInitCallback。
+     **/
+    void setBusyPoll(int64_t maxSpinUs, int64_t minSpinUs = 0);
+    BusyPollStats busyPollStats() const;
+
+    // 每轮最多执行的跨线程回调数，剩余的留在队列中下一轮继续，且下一轮poll不阻塞；0表示不限制（默认）。
+    // 限制大批回调对同一loop上IO事件的延迟影响。需在loop线程中或loop()开始前调用
+    void setFunctorBudget(size_t maxFunctors) { functorBudget_ = maxFunctors; }
+
+    // 运行指标快照（线程安全，可在其他线程无锁读取）：poll等待/事件处理/回调执行耗时、每次poll事件数、回调队列深度、唤醒次数、合并掉的epoll_ctl次数
+    EventLoopMetrics::Snapshot metricsSnapshot() const;
+
+    // 负载信息（可在任意线程无锁读取），供EventLoopThreadPool按负载分发连接
+    int connectionCount() const { return connectionCount_.load(std::memory_order_relaxed); }
+    void adjustConnectionCount(int delta) { connectionCount_.fetch_add(delta, std::memory_order_relaxed); }  // 由分配/回收连接的一方维护
+    size_t loadHint() const {  // 尚未执行的回调数 + 上一次poll的活跃Channel数
+        return queuedFunctors_.load(std::memory_order_relaxed) + lastActiveChannels_.load(std::memory_order_relaxed);
+    }
+
+    // 本loop上所有连接共用的读暂存区（不清零），Buffer::readFd可写空间不足时的第二块iovec
+    char* scratchBuffer() { return scratchBuffer_.get(); }
+    static const size_t kScratchBufferSize = 64 * 1024;
+    // 本loop上连接发送缓冲区（ChainBuffer）共用的slab池，只在loop线程使用
+    SlabPool& slabPool() { return *slabPool_; }
+    // 本loop上连接空闲超时共用的时间轮（tick为1秒），只在loop线程使用
+    TimingWheel& timingWheel() { return *timingWheel_; }
+
     // EventLoop的方法 => Poller的方法
     void updateChannel(Channel* channel);
     void removeChannel(Channel* channel);
@@ -38,6 +105,19 @@ public:
     bool isInLoopThread() const { return CurrentThread::t_cachedTid == threadId_; }
 
 private:
+    // 跨线程投递的任务节点：链接字段内嵌，直接挂入pendingFunctors_
+    struct PendingFunctor : MpscNode {
+        virtual ~PendingFunctor() = default;
+        virtual void run() = 0;
+    };
+    template <typename F>
+    struct PendingTask : PendingFunctor {
+        template <typename G>
+        explicit PendingTask(G&& f) : func(std::forward<G>(f)) {}
+        void run() override { func(); }
+        F func;
+    };
+
     // ==== 核心事件循环状态 ====
     std::atomic_bool looping_;  // 是否在事件循环中
     std::atomic_bool quit_;  // 是否退出循环
@@ -49,14 +129,43 @@ private:
     TimeStamp pollReturnTime_;  // Poller返回事件的时间戳
     ChannelList activeChannels_;  // 当前活跃的Channel列表
 
+    // ==== 忙轮询 ====
+    int64_t busyPollMaxUs_;  // 自旋窗口上限，0表示关闭忙轮询
+    int64_t busyPollMinUs_;  // 自旋窗口下限
+    std::atomic<int64_t> spinWindowUs_;  // 当前自旋窗口
+    std::atomic<uint64_t> spinPolls_;
+    std::atomic<uint64_t> spinHits_;
+    std::atomic<uint64_t> blockingPolls_;
+
+    // ==== 运行指标 ====
+    EventLoopMetrics metrics_;  // 由loop线程写入
+
+    // ==== 负载信息 ====
+    std::atomic<int> connectionCount_{0};  // 分配到本loop的连接数
+    std::atomic<size_t> queuedFunctors_{0};  // 已入队尚未取出的回调数
+    std::atomic<size_t> lastActiveChannels_{0};  // 上一次poll返回的活跃Channel数
+
+    // ==== 定时器 ====
+    std::unique_ptr<TimerQueue> timerQueue_;  // 基于timerfd的定时器队列
+
     // ==== 跨线程任务调度 ====
     int wakeupFd_;  // 用于唤醒的事件fd
     std::unique_ptr<Channel> wakeupChannel_;  // 绑定wakeupFd_的Channel
-    std::vector<Functor> pendingFunctors_;  // 待执行的回调队列
+    MpscQueue<PendingFunctor> pendingFunctors_;  // 待执行的回调队列（无锁侵入式，多生产者单消费者）
+    std::vector<PendingFunctor*> runningFunctors_;  // 本轮取出待执行的回调，复用容量避免反复分配
     std::atomic_bool callingPendingFunctors_;  // 是否正在执行回调
-    std::mutex mutex_;  // 保护pendingFunctors_的锁
+    std::atomic_bool wakeupPending_;  // 是否已有未处理的唤醒，用于合并多个生产者的eventfd写入
+    size_t functorBudget_;  // 每轮最多执行的回调数，0表示不限制
+    bool functorsCarriedOver_;  // 上一轮因预算耗尽留下了未执行的回调
+
+    // ==== 读暂存区 ====
+    std::unique_ptr<char[]> scratchBuffer_;  // new char[]不做值初始化，只在loop线程使用
+    std::unique_ptr<SlabPool> slabPool_;
+    std::unique_ptr<TimingWheel> timingWheel_;  // 析构时取消tick定时器，须在timerQueue_之前析构
 
     // ==== 内部方法 ====
     void handleRead();  // 处理wakeupFd_的可读事件
-    void doPendingFunctors();  // 执行回调队列
+    void enqueue(PendingFunctor* task);  // 任务入队并在需要时唤醒loop
+    size_t doPendingFunctors();  // 执行回调队列，返回执行的回调数
+    TimeStamp busyPoll();  // 先自旋再阻塞的poll
 };
\ No newline at end of file
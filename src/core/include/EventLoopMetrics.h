@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+
+#include "NonCopyable.h"
+
+/**
+ * 对数线性直方图：每个2的幂区间再线性分为kSubBuckets个桶，相对误差不超过1/kSubBuckets。
+ * 只允许一个写者（loop线程）调用record，其他线程可随时无锁读取快照。
+ **/
+class LogLinearHistogram : NonCopyable {
+public:
+    static const int kSubBucketBits = 3;
+    static const int kSubBuckets = 1 << kSubBucketBits;  // 每个2的幂区间8个桶，误差约12.5%
+    static const int kMaxBits = 40;  // 覆盖到2^40（以微秒计约12天）
+    static const int kNumBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    struct Snapshot {
+        std::array<uint64_t, kNumBuckets> counts{};
+        uint64_t count = 0;  // 样本数
+        uint64_t sum = 0;  // 样本总和
+        uint64_t max = 0;  // 最大值
+
+        double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+        uint64_t percentile(double q) const;  // q取值[0,1]，返回所在桶的上界
+    };
+
+    LogLinearHistogram();
+
+    void record(uint64_t value);
+    Snapshot snapshot() const;
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketUpperBound(int bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, kNumBuckets> counts_;  // 样本数由各桶计数求和得到，不单独记录
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};
+
+// 单个EventLoop的运行指标：计数器与直方图均由loop线程写入，其他线程通过snapshot读取
+class EventLoopMetrics : NonCopyable {
+public:
+    struct Snapshot {
+        uint64_t iterations = 0;  // 循环轮数
+        uint64_t events = 0;  // 处理的IO事件总数
+        uint64_t functors = 0;  // 执行的跨线程回调总数
+        uint64_t wakeupsHandled = 0;  // eventfd被读取（loop被唤醒）的次数
+        uint64_t wakeupsWritten = 0;  // eventfd累计被写入的次数（由读取到的计数值累加）
+        uint64_t interestUpdates = 0;  // Channel兴趣事件的更新次数
+        uint64_t interestUpdatesSaved = 0;  // 其中被合并/抵消、没有产生epoll_ctl的次数
+        uint64_t bufferBytesInUse = 0;  // 本loop连接缓冲区占用的内存（slabPool分配出去的字节数）
+        uint64_t bufferBytesCached = 0;  // slabPool空闲链表中缓存的字节数
+        LogLinearHistogram::Snapshot pollWaitUs;  // poll等待时间（微秒）
+        LogLinearHistogram::Snapshot handleEventUs;  // 处理活跃Channel的时间（微秒）
+        LogLinearHistogram::Snapshot pendingFunctorsUs;  // doPendingFunctors耗时（微秒）
+        LogLinearHistogram::Snapshot eventsPerPoll;  // 每次poll返回的事件数
+        LogLinearHistogram::Snapshot pendingFunctorDepth;  // 每轮取出的待执行回调数
+    };
+
+    // ==== loop线程调用 ====
+    void recordIteration(uint64_t pollWaitUs, uint64_t events, uint64_t handleEventUs, uint64_t functors, uint64_t pendingFunctorsUs);
+    void recordWakeup(uint64_t writes);
+
+    // ==== 任意线程调用 ====
+    Snapshot snapshot() const;
+
+private:
+    // 单写者计数器：load+store代替fetch_add，避免带锁前缀的指令
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) { counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+
+    std::atomic<uint64_t> iterations_{0};
+    std::atomic<uint64_t> events_{0};
+    std::atomic<uint64_t> functors_{0};
+    std::atomic<uint64_t> wakeupsHandled_{0};
+    std::atomic<uint64_t> wakeupsWritten_{0};
+    LogLinearHistogram pollWaitUs_;
+    LogLinearHistogram handleEventUs_;
+    LogLinearHistogram pendingFunctorsUs_;
+    LogLinearHistogram eventsPerPoll_;
+    LogLinearHistogram pendingFunctorDepth_;
+};
@@ -19,6 +19,10 @@ public:
 
     EventLoop* startLoop();
 
+    // 绑定到指定CPU（需在startLoop之前调用），-1表示不绑定
+    // 绑定在EventLoop创建之前完成，loop线程中首次分配的内存（Buffer等）按first-touch策略落在本地NUMA节点
+    void setCpuAffinity(int cpu) { cpu_ = cpu; }
+
 private:
     // ==== 核心组件 ====
     EventLoop* loop_;  // 事件循环对象指针
@@ -26,6 +30,7 @@ private:
 
     // ==== 线程控制 ====
     bool exiting_;  // 退出标志
+    int cpu_;  // 绑定的CPU，-1表示不绑定
     std::mutex mutex_;  // 保护loop_的互斥锁
     std::condition_variable cond_;  // 用于loop_初始化的条件变量
 
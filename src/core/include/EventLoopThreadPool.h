@@ -1,30 +1,65 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "EventLoopMetrics.h"
 #include "NonCopyable.h"
 class EventLoop;
 class EventLoopThread;
+class InetAddress;
 
 class EventLoopThreadPool : NonCopyable {
 public:
     using ThreadInitCallback = std::function<void(EventLoop*)>;
 
+    // subloop线程的CPU放置策略
+    enum PlacementPolicy {
+        kNoAffinity,  // 不绑定，由内核调度（默认）
+        kExplicitCpus,  // 按给定的CPU列表依次绑定
+        kOnePerPhysicalCore,  // 每个物理核绑定一个loop，不与超线程兄弟共享
+        kSpreadNumaNodes,  // 在NUMA节点间轮流分配，节点内按物理核分配
+    };
+
+    // 新连接分发到subloop的策略
+    enum DispatchPolicy {
+        kRoundRobin,  // 轮询（默认）
+        kLeastConnections,  // 选择连接数最少的loop，连接数相同时轮流选择
+        kPowerOfTwoChoices,  // 随机取两个loop，选择负载（连接数+待执行回调+活跃Channel）较低者
+        kHashByPeer,  // 按对端IP哈希，同一客户端总是落在同一个loop
+    };
+
     EventLoopThreadPool(EventLoop* baseLoop, const std::string& nameArg);
     ~EventLoopThreadPool();
 
     void setThreadNum(int numThreads) { numThreads_ = numThreads; }
 
+    // 设置放置策略（需在start之前调用），cpus仅在kExplicitCpus下使用；线程数多于可用CPU时循环复用
+    void setPlacement(PlacementPolicy policy, const std::vector<int>& cpus = std::vector<int>()) {
+        placement_ = policy;
+        cpus_ = cpus;
+    }
+    // 按策略计算前n个loop线程各自绑定的CPU，-1表示不绑定
+    static std::vector<int> planCpus(PlacementPolicy policy, int n, const std::vector<int>& cpus);
+
+    void setDispatchPolicy(DispatchPolicy policy) { dispatch_ = policy; }
+    DispatchPolicy dispatchPolicy() const { return dispatch_; }
+
     void start(const ThreadInitCallback& cb = ThreadInitCallback());
 
-    // 如果工作在多线程中，baseLoop_(mainLoop)会默认以轮询的方式分配Channel给subLoop
+    // 如果工作在多线程中，baseLoop_(mainLoop)按分发策略选择subLoop；只能在baseLoop_线程调用
     EventLoop* getNextLoop();
+    // 同上，kHashByPeer策略下按peerAddr选择，其余策略忽略peerAddr
+    EventLoop* getNextLoop(const InetAddress& peerAddr);
 
     std::vector<EventLoop*> getAllLoops();  // 获取所有的EventLoop
 
+    // 所有loop的运行指标快照，顺序与getAllLoops()一致；可在任意线程调用
+    std::vector<EventLoopMetrics::Snapshot> metricsSnapshots();
+
     bool isStarted() const { return started_; }  // 是否已经启动
     const std::string getName() const { return name_; }  // 获取名字
 
@@ -37,6 +72,15 @@ private:
     bool started_;  // 启动状态
     int numThreads_;  // 线程数量
     int next_;  // 轮询索引
+    PlacementPolicy placement_;  // CPU放置策略
+    std::vector<int> cpus_;  // kExplicitCpus使用的CPU列表
+    DispatchPolicy dispatch_;  // 连接分发策略
+    uint64_t randomState_;  // kPowerOfTwoChoices使用的xorshift随机数状态
+
+    // ==== 分发策略实现 ====
+    EventLoop* roundRobin();
+    EventLoop* leastConnections();
+    EventLoop* powerOfTwoChoices();
 
     // ==== 线程资源 ====
     std::vector<std::unique_ptr<EventLoopThread>> threads_;  // 线程列表
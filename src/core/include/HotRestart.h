@@ -0,0 +1,62 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Channel.h"
+#include "NonCopyable.h"
+
+class EventLoop;
+class TcpServer;
+
+/**
+ * 零停机热升级：旧进程通过Unix域套接字（SOCK_SEQPACKET）把监听socket和空闲连接以SCM_RIGHTS交给新进程。
+ *
+ * 旧进程：HotRestart hot(&loop, &server, path); hot.listen();
+ *   新进程连接path后，旧进程发出监听fd并停止accept，随后把空闲连接（连同输入缓冲区中未处理的数据）逐个交出，
+ *   正在发送数据的连接留在旧进程排空；全部发送完毕后在mainLoop中调用HandOffCompleteCallback，旧进程可等连接排空后退出。
+ * 新进程：HotRestart::takeOver(path, &state) 取回fd，以state.listenFd构造TcpServer，start之后逐个adoptConnection。
+ **/
+class HotRestart : NonCopyable {
+public:
+    using HandOffCompleteCallback = std::function<void()>;
+
+    // 从旧进程接收到的状态
+    struct InheritedConnection {
+        int sockfd;
+        std::string pendingInput;  // 旧进程输入缓冲区中尚未处理的数据
+    };
+    struct TakeOverState {
+        int listenFd = -1;
+        std::vector<InheritedConnection> connections;
+    };
+
+    HotRestart(EventLoop* loop, TcpServer* server, const std::string& path);
+    ~HotRestart();
+
+    // 是否交接空闲连接（默认交接）；关闭时只交接监听socket，已有连接全部留在旧进程排空
+    void setHandOffConnections(bool on) { handOffConnections_ = on; }
+    void setHandOffCompleteCallback(const HandOffCompleteCallback& cb) { handOffCompleteCallback_ = cb; }
+
+    // 旧进程：在path上等待新进程的升级请求（在loop线程调用）
+    void listen();
+
+    // 新进程：连接旧进程并接收全部fd，阻塞直到旧进程交接完成；失败返回false（此时应自行bind）
+    static bool takeOver(const std::string& path, TakeOverState* state);
+
+    // 单个连接携带的未处理输入上限，超出的连接留在旧进程排空
+    static const size_t kMaxPendingInput = 60 * 1024;
+
+private:
+    EventLoop* loop_;
+    TcpServer* server_;
+    const std::string path_;
+    int listenFd_;  // Unix域监听socket
+    Channel listenChannel_;
+    bool handOffConnections_;
+    HandOffCompleteCallback handOffCompleteCallback_;
+
+    void handleRead();  // 新进程发起升级
+    void handOff(int controlFd);
+};
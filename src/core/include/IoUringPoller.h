@@ -0,0 +1,85 @@
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <vector>
+
+#include "Poller.h"
+#include "TimeStamp.h"
+
+/**
+ * 基于io_uring的Poller实现（直接使用系统调用，不依赖liburing）
+ * 1.io_uring_setup 创建SQ/CQ环并mmap到用户态
+ * 2.IORING_OP_POLL_ADD/POLL_REMOVE 代替 epoll_ctl(add, mod, del)
+ * 3.io_uring_enter 一次系统调用同时完成提交与等待，代替 epoll_wait
+ *
+ * 兴趣变更只是写入SQ，并在下一次poll时与等待合并为一次io_uring_enter，
+ * 因此每轮循环无论有多少fd需要(重新)注册，系统调用次数都为1。
+ * 普通Channel使用单次(oneshot)poll并在下一轮自动重新注册，保持与EPollPoller相同的水平触发语义；
+ * 边沿触发的Channel使用multishot poll，一次注册持续生效。
+ **/
+class Channel;
+class IoUringPoller : public Poller {
+public:
+    IoUringPoller(EventLoop* loop);
+    ~IoUringPoller() override;
+
+    TimeStamp poll(int timeoutMs, ChannelList* activeChannels) override;
+    void updateChannel(Channel* channel) override;
+    void removeChannel(Channel* channel) override;
+
+    // 探测内核是否支持本实现需要的io_uring特性
+    static bool isSupported();
+
+private:
+    // 每个fd当前poll请求的状态
+    struct PollState {
+        uint64_t token = 0;  // 当前有效请求的user_data（fd << 32 | 序号），旧请求的完成事件据此丢弃
+        bool armed = false;  // 请求是否仍在内核中等待
+    };
+    // 与channels_一样以fd为下标
+    using PollStateTable = std::vector<PollState>;
+
+    // ==== 核心io_uring资源 ====
+    int ringfd_;  // io_uring实例的文件描述符
+
+    // ==== SQ环（提交队列） ====
+    void* sqRingPtr_;
+    size_t sqRingSize_;
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned sqRingMask_;
+    unsigned* sqArray_;
+    io_uring_sqe* sqes_;
+    size_t sqesSize_;
+    unsigned sqeTail_;  // 本地已填充但尚未发布的SQE尾部
+    unsigned sqeHead_;  // 本地已发布的SQE位置
+
+    // ==== CQ环（完成队列） ====
+    void* cqRingPtr_;
+    size_t cqRingSize_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqRingMask_;
+    io_uring_cqe* cqes_;
+
+    // ==== poll请求状态 ====
+    PollStateTable states_;  // fd => 当前请求状态
+    std::vector<int> rearmFds_;  // 上一轮触发、需要重新注册的fd
+    uint32_t nextSeq_;  // 请求序号
+
+    // ==== 常量配置 ====
+    static const unsigned kRingEntries = 1024;  // SQ大小
+    static const unsigned kCqEntries = 16384;  // CQ大小，需要容纳所有在途poll请求的完成事件
+    static const uint64_t kIgnoredToken = 0;  // POLL_REMOVE等不关心完成结果的请求
+
+    // ==== 内部方法 ====
+    PollState& stateOf(int fd);  // 获取fd对应的请求状态，不足时按需扩容
+    io_uring_sqe* getSqe();  // 获取一个空闲SQE，SQ满时先提交
+    unsigned flushSq();  // 把本地SQE发布到SQ环，返回待提交数量
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, int timeoutMs);
+    void armPoll(int fd, Channel* channel);  // 提交POLL_ADD
+    void cancelPoll(PollState& state);  // 提交POLL_REMOVE
+    void rearmFired();  // 重新注册上一轮触发过的fd
+    int reapCompletions(ChannelList* activeChannels);  // 收割CQE并填充活跃Channel
+};
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "NonCopyable.h"
@@ -26,13 +28,45 @@ public:
     // 判断参数channel是否在当前的Poller当中
     bool hasChannel(Channel* channel) const;
 
+    // 兴趣事件更新统计（可在其他线程读取）：updateChannel调用次数，以及其中被合并/抵消而未产生系统调用的次数
+    uint64_t updatesRequested() const { return updatesRequested_.load(std::memory_order_relaxed); }
+    uint64_t updatesSaved() const { return updatesSaved_.load(std::memory_order_relaxed); }
+
     // EventLoop可以通过该接口获取默认的IO复用的具体实现
     static Poller* newDefaultPoller(EventLoop* loop);
 
 protected:
-    // map的kv值: key:sockfd value:sockfd所属的channel通道类型
-    using ChannelMap = std::unordered_map<int, Channel*>;
-    ChannelMap channels_;
+    // Channel在Poller中的注册状态
+    enum ChannelState {
+        kNew = -1,  // 还未添加至Poller
+        kAdded = 1,  // 已添加
+        kDeleted = 2  // 已从内核中删除（无关注事件），但仍保留在表中
+    };
+    struct ChannelEntry {
+        Channel* channel = nullptr;  // fd所属的Channel
+        ChannelState state = kNew;  // 该Channel的注册状态
+        bool dirty = false;  // 兴趣事件已变更，尚未同步到内核
+        bool rearm = false;  // 边沿触发的Channel本轮改变过兴趣事件：即使最终与内核中一致也要MOD，让内核重新报告已就绪的事件
+        uint32_t registeredEvents = 0;  // 内核中当前登记的事件（state为kAdded时有效）
+    };
+    // 以fd为下标的扁平表：fd是小而稠密的整数，直接寻址代替哈希，增删连接时也没有节点分配
+    using ChannelTable = std::vector<ChannelEntry>;
+    ChannelTable channels_;
+
+    // 获取fd对应的表项，不足时按需扩容
+    ChannelEntry& entryOf(int fd) {
+        if (static_cast<size_t>(fd) >= channels_.size()) {
+            channels_.resize(std::max<size_t>(fd + 1, channels_.size() * 2));
+        }
+        return channels_[fd];
+    }
+    // 查找fd对应的Channel，不存在时返回nullptr
+    Channel* findChannel(int fd) const { return static_cast<size_t>(fd) < channels_.size() ? channels_[fd].channel : nullptr; }
+
+    // 单写者计数器（poller所属loop线程）
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) { counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    std::atomic<uint64_t> updatesRequested_{0};
+    std::atomic<uint64_t> updatesSaved_{0};
 
 private:
     EventLoop* ownerLoop_;  // 定义Poller所属的事件循环EventLoop
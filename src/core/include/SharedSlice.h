@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+
+/**
+ * 引用计数的只读数据片：多个连接发送同一份数据（广播）时只保存引用，不复制内容。
+ * 拷贝SharedSlice只增加引用计数；数据在最后一个引用（含各连接发送队列中的引用）释放时销毁。
+ * 构造后内容不可修改，可在任意线程间传递。
+ **/
+class SharedSlice {
+public:
+    SharedSlice() : offset_(0), length_(0) {}
+    explicit SharedSlice(std::string data) : storage_(std::make_shared<const std::string>(std::move(data))), offset_(0), length_(storage_->size()) {}
+    SharedSlice(const char* data, size_t len) : SharedSlice(std::string(data, len)) {}
+    // 引用已有存储中[offset, offset + len)的部分
+    SharedSlice(std::shared_ptr<const std::string> storage, size_t offset, size_t len) : storage_(std::move(storage)), offset_(offset), length_(len) {}
+
+    const char* data() const { return storage_ ? storage_->data() + offset_ : nullptr; }
+    size_t size() const { return length_; }
+    bool empty() const { return length_ == 0; }
+
+    // 共享同一份存储的子片段，不复制
+    SharedSlice slice(size_t offset, size_t len = std::string::npos) const {
+        SharedSlice result(*this);
+        offset = offset < length_ ? offset : length_;
+        result.offset_ += offset;
+        result.length_ = len < length_ - offset ? len : length_ - offset;
+        return result;
+    }
+
+    long useCount() const { return storage_.use_count(); }
+    const std::shared_ptr<const std::string>& storage() const { return storage_; }
+
+private:
+    std::shared_ptr<const std::string> storage_;
+    size_t offset_;
+    size_t length_;
+};
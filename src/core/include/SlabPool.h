@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "NonCopyable.h"
+
+/**
+ * 每个EventLoop一个的分级slab池，为Buffer与ChainBuffer提供存储。
+ * 大小按2的幂分级（1KB ~ 64KB），每级一个空闲链表；超过64KB的请求直接走堆，不缓存。
+ * 只在所属loop线程分配/归还，无锁；缓冲区析构时用deallocate归还，可能在其他线程（连接在其他线程析构），
+ * 此时直接释放、只扣减统计。池须比从它分配的缓冲区存活更久。
+ * 空闲链表总量不超过maxCachedBytes，多余的直接释放。内存统计可在任意线程读取。
+ **/
+class SlabPool : NonCopyable {
+public:
+    static const size_t kMinClassSize = 1024;  // 1KB
+    static const size_t kMaxClassSize = 64 * 1024;  // 64KB
+    static const size_t kDefaultMaxCachedBytes = 4 * 1024 * 1024;  // 4MB
+
+    explicit SlabPool(size_t maxCachedBytes = kDefaultMaxCachedBytes);
+    ~SlabPool();
+
+    // 向上取整到所属级别的大小（超过kMaxClassSize时原样返回）
+    static size_t roundUp(size_t size);
+
+    char* allocate(size_t size);  // 实际可用大小为roundUp(size)
+    void release(char* data, size_t size);  // size须与allocate时一致
+    void deallocate(char* data, size_t size);  // 可在任意线程调用：所属线程中同release，其他线程直接delete[]
+
+    size_t bytesInUse() const { return bytesInUse_.load(std::memory_order_relaxed); }  // 已分配给缓冲区的字节数
+    size_t bytesCached() const { return bytesCached_.load(std::memory_order_relaxed); }  // 空闲链表中的字节数
+    uint64_t heapAllocations() const { return heapAllocations_.load(std::memory_order_relaxed); }  // 累计向堆申请的次数
+
+private:
+    static const int kNumClasses = 7;  // 1K 2K 4K 8K 16K 32K 64K
+
+    static int classOf(size_t size);  // 超过kMaxClassSize返回-1
+
+    const int ownerTid_;  // 构造所在的线程，即所属loop线程
+    std::array<std::vector<char*>, kNumClasses> freeLists_;
+    size_t maxCachedBytes_;
+    std::atomic<size_t> bytesInUse_;
+    std::atomic<size_t> bytesCached_;
+    std::atomic<uint64_t> heapAllocations_;
+};
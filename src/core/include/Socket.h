@@ -17,7 +17,14 @@ public:
     void setTcpNoDelay(bool on);  // 禁用Nagle算法
     void setReuseAddr(bool on);  // 地址重用
     void setReusePort(bool on);  // 端口重用（负载均衡）
+    bool setReusePortCpuSteering(int groupSize);  // SO_REUSEPORT组内按收包CPU选择socket
     void setKeepAlive(bool on);  // 心跳检测，设职长连接
+    bool setZeroCopy(bool on);  // SO_ZEROCOPY，内核不支持时返回false
+
+    static InetAddress getLocalAddr(int sockfd);  // getsockname
+    static InetAddress getPeerAddr(int sockfd);  // getpeername
+    static int getSocketError(int sockfd);  // SO_ERROR
+    static bool isSelfConnect(int sockfd);  // 本地地址与对端地址相同（连接本机未监听端口时可能发生）
 
 private:
     const int sockfd_;
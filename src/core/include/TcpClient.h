@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "Callbacks.h"
+#include "Connector.h"
+#include "InetAddress.h"
+#include "NonCopyable.h"
+#include "TcpConnection.h"
+
+class EventLoop;
+
+/**
+ * 对外的客户端编程使用的类：Connector负责建立连接，连接建立后与服务端共用TcpConnection，
+ * 收发、关闭、高水位等行为与TcpServer一侧完全一致。一个TcpClient同一时刻最多持有一个连接。
+ **/
+class TcpClient : NonCopyable {
+public:
+    TcpClient(EventLoop* loop, const InetAddress& serverAddr, const std::string& nameArg);
+    ~TcpClient();
+
+    void connect();  // 开始连接（可跨线程调用）
+    void disconnect();  // 关闭当前连接的写端，等对端关闭
+    void stop();  // 停止连接中的Connector（已建立的连接不受影响）
+
+    TcpConnectionPtr connection() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return connection_;
+    }
+
+    EventLoop* getLoop() const { return loop_; }
+    const std::string& name() const { return name_; }
+    // 连接建立后被断开时自动重连（指数退避由Connector负责）
+    bool retry() const { return retry_; }
+    void enableRetry() { retry_ = true; }
+    // 调整退避、超时、重试次数等连接参数（需在connect之前调用）
+    Connector& connector() { return *connector_; }
+
+    void setConnectionCallback(const ConnectionCallback& cb) { connectionCallback_ = cb; }
+    void setMessageCallback(const MessageCallback& cb) { messageCallback_ = cb; }
+    void setWriteCompleteCallback(const WriteCompleteCallback& cb) { writeCompleteCallback_ = cb; }
+    // Connector放弃重试时调用
+    void setConnectFailedCallback(const Connector::ConnectFailedCallback& cb) { connector_->setConnectFailedCallback(cb); }
+
+private:
+    void newConnection(int sockfd);  // 在loop线程中由Connector回调
+    void removeConnection(const TcpConnectionPtr& conn);  // 在loop线程中由TcpConnection关闭时回调
+
+    EventLoop* loop_;
+    ConnectorPtr connector_;
+    const std::string name_;
+    ConnectionCallback connectionCallback_;
+    MessageCallback messageCallback_;
+    WriteCompleteCallback writeCompleteCallback_;
+    std::atomic_bool retry_;
+    std::atomic_bool connect_;
+    int nextConnId_;  // 仅在loop线程访问
+    mutable std::mutex mutex_;
+    TcpConnectionPtr connection_;  // 由mutex_保护
+};
@@ -1,14 +1,19 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Buffer.h"
 #include "Callbacks.h"
+#include "ChainBuffer.h"
 #include "InetAddress.h"
 #include "NonCopyable.h"
 #include "TimeStamp.h"
+#include "TimingWheel.h"
 
 class Channel;
 class EventLoop;
@@ -31,12 +36,45 @@ public:
 
     bool connected() const { return state_ == kConnected; }
 
-    // 发送数据
+    // 发送数据（线程安全）；跨线程调用时右值和Buffer的内容被移交给loop，不再复制
     void send(const std::string& buf);
+    void send(std::string&& buf);
+    void send(const char* data, size_t len);
+    void send(Buffer* buf);  // 发送并清空buf；loop线程内直接从buf写出，跨线程时交换存储（池存储仍按值复制）
+    // 发送共享数据片（线程安全）：广播时各连接只持有引用，未写完的部分留在发送队列中直接从共享存储writev
+    void send(const SharedSlice& slice);
+    /**
+     * 发送文件（线程安全）：排在已缓冲的数据（如响应头）之后，之后send的数据排在文件之后。
+     * 普通文件用sendfile从offset开始发送count字节；管道和socket用splice转发count字节（忽略offset，源提前EOF时提前结束）。
+     * 由EPOLLOUT驱动续传，socket写满时不占CPU；源暂无数据时在源fd上等待可读（管道/socket源会被设为非阻塞，且不能再注册到其他Channel）。
+     * fd归调用方所有，须保持打开直到WriteCompleteCallback（在最后一个字节写出后调用）或连接关闭。
+     **/
     void sendFile(int fileDescriptor, off_t offset, size_t count);
+    bool isSending() const;  // 发送队列（缓冲数据与文件）是否还有数据等待写出（loop线程调用）
+    // 在loop线程把数据直接序列化进发送缓冲区（排在已排队的数据之后），省去中间Buffer；fill返回后尝试立即发送
+    template <typename Fill>
+    void appendToOutput(Fill&& fill) {
+        size_t oldLen = outputBuffer_.readableBytes();
+        bool wasSending = isSending();
+        fill(&outputBuffer_);
+        outputAppended(oldLen, wasSending);
+    }
+
+    // 暂停/恢复读取（线程安全）：暂停期间不监听EPOLLIN，对端数据留在内核接收缓冲区，由TCP流控反压对端
+    void startRead();
+    void stopRead();
+    bool isReading() const { return reading_; }
+    /**
+     * 自动读反压（需在loop线程或connectEstablished之前设置）：发送缓冲区达到highWaterMark时暂停读取，
+     * 写出到不超过lowWaterMark时恢复，限制只发不收的慢客户端（如流水线请求却不读响应）占用的内存。
+     * highWaterMark同时作为HighWaterMarkCallback的阈值；highWaterMark为0表示关闭。与stopRead独立，两者都允许时才读。
+     **/
+    void setReadBackpressure(size_t highWaterMark, size_t lowWaterMark);
 
     // 关闭半连接
     void shutdown();
+    // 立即关闭连接，不等待输出缓冲区发送完毕（线程安全）
+    void forceClose();
 
     void setConnectionCallback(const ConnectionCallback& cb) { connectionCallback_ = cb; }
     void setMessageCallback(const MessageCallback& cb) { messageCallback_ = cb; }
@@ -47,6 +85,41 @@ public:
         highWaterMark_ = highWaterMark;
     }
 
+    // 边沿触发模式（需在connectEstablished之前设置）：读写均循环到EAGAIN，EPOLLOUT常驻不再反复开关
+    void setEdgeTriggered(bool on);
+    // 单次事件最多读取的字节数（边沿触发模式下同时限制写），超出后让出loop：LT模式等下一轮poll，ET模式在本轮循环末尾继续；0表示不限制
+    void setEventByteBudget(size_t bytes) { eventByteBudget_ = bytes == 0 ? std::numeric_limits<size_t>::max() : bytes; }
+
+    /**
+     * 零拷贝发送（loop线程或connectEstablished之前调用）：不小于bytes的SharedSlice以MSG_ZEROCOPY发送，
+     * 内核直接引用共享存储的页面，完成通知从socket错误队列读取后才释放对存储的引用。
+     * 只作用于SharedSlice，std::string可以move进SharedSlice后发送。bytes为0表示关闭；内核不支持时保持关闭。
+     * 内核仍然复制（如对端在本机回环、网卡不支持分散/聚集）时，收到第一个标记为已复制的通知后自动回到普通路径。
+     **/
+    void setZeroCopyThreshold(size_t bytes);
+    bool zeroCopyEnabled() const { return zeroCopyThreshold_ > 0; }
+
+    /**
+     * 空闲超时（秒，需在connectEstablished之前设置，0表示不限制）：超过readIdle秒没有读到数据、
+     * 超过writeIdle秒没有向socket写出数据（包括有数据却因对端不读而写不出去）、或建立超过lifetime秒时强制关闭。
+     * 由所属loop的TimingWheel统一计时，每次读写只记录当前tick，关闭时间最多比超时晚两个tick（tick为1秒）。
+     **/
+    void setIdleTimeouts(double readIdle, double writeIdle, double lifetime);
+
+    static const size_t kDefaultEventByteBudget = 1024 * 1024;  // 1M
+    static constexpr double kInputShrinkDelay = 5.0;  // 残留部分消息的输入缓冲区空闲多久（秒）后收缩
+
+    /**
+     * 热升级：把连接交给另一个进程（在loop线程调用）。
+     * 只交接空闲连接（已连接且没有待发送数据）：停止读取后以(fd, 输入缓冲区中未处理的数据)调用transfer，
+     * transfer成功（fd已通过SCM_RIGHTS发出）后本端按关闭流程处理（ConnectionCallback会收到断开），
+     * 但fd仍被接收方持有，不会发出FIN。
+     **/
+    using HandOffFunction = std::function<bool(int sockfd, const std::string& pendingInput)>;
+    bool handOffInLoop(const HandOffFunction& transfer);
+    // 热升级接收端：把旧进程未处理完的输入放回输入缓冲区并上报（在connectEstablished之后、loop线程调用）
+    void restoreInput(const std::string& pendingInput);
+
     // 连接建立
     void connectEstablished();
     // 连接销毁
@@ -62,7 +135,11 @@ private:
     // ==== 核心状态与组件 ====
     EventLoop* loop_;  // 若为多Reactor 该loop_指向subloop；若为单Reactor 该loop_指向baseloop；
     std::atomic_int state_;  // 连接状态，与loop_强相关
-    bool reading_;  // 连接是否在监听读事件
+    bool reading_;  // 用户是否允许读（stopRead/startRead）
+    bool readPaused_;  // 是否因发送缓冲区超过高水位而暂停读
+    bool backpressure_;  // 是否开启自动读反压
+    bool edgeTriggered_;  // 是否为边沿触发模式
+    size_t eventByteBudget_;  // 单次事件的读写字节预算
 
     // ==== 网络资源 ====
     // Socket Channel
@@ -76,11 +153,50 @@ private:
     const InetAddress peerAddr_;  // 对端地址
 
     // ==== 数据缓冲区 ====
-    Buffer inputBuffer_;               // 接收缓冲区（高频访问）
-    Buffer outputBuffer_;              // 发送缓冲区
+    Buffer inputBuffer_;               // 接收缓冲区（高频访问，存储来自loop的slabPool，处理完即归还）
+    ChainBuffer outputBuffer_;         // 发送缓冲区（slab链，追加不搬移已有数据，writev发送）
+    TimeStamp lastReadTime_;           // 最近一次读到数据的时间
+    bool inputShrinkScheduled_;        // 是否已安排残留输入的空闲收缩
+
+    // ==== 文件发送 ====
+    struct FileTransfer {
+        enum Kind { kRegularFile, kPipe, kSocket };
+        FileTransfer(int fileDescriptor, off_t off, size_t count);
+        ~FileTransfer();
+
+        int fd;
+        Kind kind;
+        off_t offset;  // 普通文件的下一个发送位置，由sendfile更新
+        size_t remaining;  // 还要发送的字节数
+        size_t bytesBefore;  // 发送缓冲区中排在该文件之前、尚未写出的字节数
+        int pipeFds[2];  // socket源的中转管道
+        size_t pipeBytes;  // 中转管道中尚未写出的字节数
+        std::unique_ptr<Channel> sourceChannel;  // 源暂无数据时监听其可读
+    };
+    static constexpr size_t kSplicePipeSize = 64 * 1024;  // 管道默认容量
+    std::vector<std::unique_ptr<FileTransfer>> fileTransfers_;  // 按顺序排队的文件
+
+    // ==== 零拷贝发送 ====
+    struct PendingZeroCopy {
+        uint32_t id;  // 内核为每次成功的MSG_ZEROCOPY发送分配的序号
+        std::shared_ptr<const std::string> storage;  // 内核完成前保持存储存活
+    };
+    size_t zeroCopyThreshold_;               // 0表示不使用零拷贝
+    bool zeroCopySocket_;                    // socket已开启SO_ZEROCOPY：即使回退到普通发送，错误队列仍可能收到通知
+    uint32_t zeroCopyNextId_;                // 下一次零拷贝发送的序号
+    std::vector<PendingZeroCopy> zeroCopyPending_;  // 已发送、等待完成通知的存储
+
+    // ==== 空闲超时 ====
+    double readIdleTimeout_;
+    double writeIdleTimeout_;
+    double lifetimeLimit_;
+    TimingWheel::EntryPtr readIdleEntry_;   // 读到数据时touch
+    TimingWheel::EntryPtr writeIdleEntry_;  // 写出数据时touch
+    TimingWheel::EntryPtr lifetimeEntry_;   // 从不touch
 
     // ==== 水位控制 ====
     size_t highWaterMark_;             // 高水位阈值
+    size_t lowWaterMark_;              // 自动读反压的恢复阈值
     HighWaterMarkCallback highWaterMarkCallback_;// 高水位回调
 
     // ==== 用户回调 ==== 
@@ -94,9 +210,43 @@ private:
     void setState(StateE state) { state_ = state; }
     void handleRead(TimeStamp receiveTime);
     void handleWrite();  // 处理写事件
+    void handleReadEdgeTriggered(TimeStamp receiveTime);
+    void releaseInputIfIdle(TimeStamp receiveTime);
+    void scheduleInputShrink(double delay);
+    void handleWriteEdgeTriggered();
     void handleClose();
     void handleError();
-    void sendInLoop(const void* data, size_t len);
+    void sendInLoop(const void* data, size_t len, const SharedSlice* shared = nullptr);
+    void outputAppended(size_t oldLen, bool wasSending);
+    void startReadInLoop();
+    void stopReadInLoop();
+    void updateReading();  // 按reading_与readPaused_开关EPOLLIN
+    void checkBackpressure();  // 发送缓冲区变化后检查是否需要暂停/恢复读
+    TimingWheel::EntryPtr armIdleTimer(double timeout, const char* reason);
+    void startIdleTimers();
+    void cancelIdleTimers();
+    void touchRead() {
+        if (readIdleEntry_) {
+            readIdleEntry_->touch();
+        }
+    }
+    void touchWrite() {
+        if (writeIdleEntry_) {
+            writeIdleEntry_->touch();
+        }
+    }
+    bool hasPendingOutput() const { return outputBuffer_.readableBytes() > 0 || !fileTransfers_.empty(); }
+    void startOutput();
+    ssize_t writeOutput(int* saveErrno, size_t maxBytes);
+    ssize_t writeBuffered(int* saveErrno, size_t maxBytes);
+    ssize_t transferFile(FileTransfer& file, int* saveErrno, size_t maxBytes);
+    void waitForSource(FileTransfer& file);
+    void sourceReadable();
+    bool waitingForSource() const;
+    void cancelFileTransfers();  // 连接关闭时丢弃排队的文件
+    ssize_t sendZeroCopy(const char* data, size_t len, const SharedSlice& owner);
+    bool readZeroCopyCompletions();
     void shutdownInLoop();
+    void forceCloseInLoop();
     void sendFileInLoop(int fileDescriptor, off_t offset, size_t count);
 };
@@ -7,8 +7,10 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "Acceptor.h"
 #include "Buffer.h"
@@ -30,6 +32,8 @@ public:
     };
 
     TcpServer(EventLoop* loop, const InetAddress& listenAddr, const std::string& nameArg, Option option = kNoReusePort);
+    // 使用已经在监听的socket（如热升级时从旧进程收到的fd），不再bind
+    TcpServer(EventLoop* loop, int listenFd, const std::string& nameArg);
     ~TcpServer();
 
     void setThreadInitCallback(const ThreadInitCallback& cb) { threadInitCallback_ = cb; }
@@ -39,6 +43,35 @@ public:
 
     // 设置底层subloop的个数
     void setThreadNum(int numThreads);
+    // 设置新连接分发到subloop的策略（默认轮询）
+    void setDispatchPolicy(EventLoopThreadPool::DispatchPolicy policy) { threadPool_->setDispatchPolicy(policy); }
+    // 设置subloop线程的CPU放置策略（需在start之前调用）
+    void setThreadPlacement(EventLoopThreadPool::PlacementPolicy policy, const std::vector<int>& cpus = std::vector<int>()) { threadPool_->setPlacement(policy, cpus); }
+
+    // 开启边沿触发模式（需在start之前调用）：监听socket与所有新连接都以EPOLLET注册
+    void setEdgeTriggered(bool on);
+    /**
+     * 每个loop各自持有一个以SO_REUSEPORT绑定同一端口的Acceptor（需在start之前调用）：
+     * 由内核在各监听socket间分发连接，loop直接accept并管理连接，不再经mainLoop转交，省去每个连接一次跨线程唤醒。
+     * cpuSteering为true时挂载cBPF程序，按收包CPU选择acceptor；需配合setThreadPlacement让第i个loop绑定CPU i。
+     **/
+    void setAcceptorPerLoop(bool on, bool cpuSteering = false) {
+        acceptorPerLoop_ = on;
+        cpuSteering_ = cpuSteering;
+    }
+    // 每个连接单次事件的读字节预算（边沿触发模式下同时限制写），0表示不限制
+    void setEventByteBudget(size_t bytes) { eventByteBudget_ = bytes; }
+    // 所有新连接的空闲超时（秒，见TcpConnection::setIdleTimeouts），0表示不限制
+    void setIdleTimeouts(double readIdle, double writeIdle, double lifetime) {
+        readIdleTimeout_ = readIdle;
+        writeIdleTimeout_ = writeIdle;
+        lifetimeLimit_ = lifetime;
+    }
+    // 所有新连接开启自动读反压（见TcpConnection::setReadBackpressure），highWaterMark为0表示关闭
+    void setReadBackpressure(size_t highWaterMark, size_t lowWaterMark) {
+        backpressureHighWaterMark_ = highWaterMark;
+        backpressureLowWaterMark_ = lowWaterMark;
+    }
     /**
      * 如果没有监听, 就启动服务器(监听).
      * 多次调用没有副作用.
@@ -46,24 +79,47 @@ public:
      */
     void start();
 
+    // ==== 热升级（见HotRestart） ====
+    // 当前监听socket的fd，每loop Acceptor模式下或已停止监听时返回-1（在mainLoop线程调用）
+    int listenFd() const { return acceptor_ ? acceptor_->listenFd() : -1; }
+    // 关闭监听，不再接受新连接，已有连接不受影响（在mainLoop线程调用）
+    void stopListening();
+    // 接管一个已建立的连接，pendingInput为旧进程中尚未处理的输入（start之后调用，线程安全）
+    void adoptConnection(int sockfd, const std::string& pendingInput = std::string());
+    // 当前所有连接（线程安全）
+    std::vector<TcpConnectionPtr> connectionList();
+    size_t connectionCount();
+
 private:
     using ConnectionMap = std::unordered_map<std::string, TcpConnectionPtr>;
     // ==== 核心组件 ====
     EventLoop* loop_;  // Main Reactor（必须首位）
     const std::string ipPort_;  // 监听地址（格式 "IP:PORT"）
     const std::string name_;  // 服务名称
+    const InetAddress listenAddr_;  // 监听地址
 
     // ==== 网络资源 ====
     std::unique_ptr<Acceptor> acceptor_;  // 连接接收器（主循环）
     std::shared_ptr<EventLoopThreadPool> threadPool_;  // 线程池
+    std::vector<std::unique_ptr<Acceptor>> loopAcceptors_;  // 每个loop一个的SO_REUSEPORT Acceptor
 
     // ==== 连接管理 ====
+    std::mutex connectionsMutex_;  // 每loop Acceptor模式下各loop并发增删连接
     ConnectionMap connections_;  // 活跃连接表（核心状态）
     std::atomic_int nextConnId_;  // 连接ID生成器
 
     // ==== 配置参数 ====
     int numThreads_;  // 子线程数
     std::atomic_int started_;  // 启动状态标志
+    bool edgeTriggered_;  // 是否为边沿触发模式
+    size_t eventByteBudget_;  // 每个连接单次事件的读字节预算（边沿触发模式下同时限制写），0表示不限制
+    size_t backpressureHighWaterMark_;  // 自动读反压的暂停阈值，0表示关闭
+    size_t backpressureLowWaterMark_;  // 自动读反压的恢复阈值
+    double readIdleTimeout_;  // 读空闲超时，0表示不限制
+    double writeIdleTimeout_;  // 写空闲超时，0表示不限制
+    double lifetimeLimit_;  // 连接最长存活时间，0表示不限制
+    bool acceptorPerLoop_;  // 是否每个loop各自accept
+    bool cpuSteering_;  // 是否按收包CPU选择acceptor
 
     // ==== 用户回调 ====
     ConnectionCallback connectionCallback_;
@@ -73,6 +129,11 @@ private:
 
     // ==== 内部方法 ====
     void newConnection(int sockfd, const InetAddress& peerAddr);
+    void newConnections(const std::vector<Acceptor::AcceptedSocket>& batch);  // mainLoop一次accept到的一批连接
+    void newConnectionInLoop(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr);  // 在ioLoop线程或mainLoop线程调用
+    TcpConnectionPtr createConnection(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr);  // 创建连接并登记，尚未在ioLoop中建立
+    void startLoopAcceptors();
+    void setupAcceptor();
     void removeConnection(const TcpConnectionPtr& conn);
     void removeConnectionInLoop(const TcpConnectionPtr& conn);
 };
\ No newline at end of file
@@ -43,4 +43,28 @@ public:
     int64_t getMicroSecondsSinceEpoch() const{
         return microSecondsSinceEpoch_;
     }
+    // 是否为有效时间戳（默认构造的0视为无效）
+    bool valid() const { return microSecondsSinceEpoch_ > 0; }
+
+    static const int64_t kMicroSecondsPerSecond = 1000 * 1000;
 };
+
+inline bool operator<(TimeStamp lhs, TimeStamp rhs) {
+    return lhs.getMicroSecondsSinceEpoch() < rhs.getMicroSecondsSinceEpoch();
+}
+
+inline bool operator==(TimeStamp lhs, TimeStamp rhs) {
+    return lhs.getMicroSecondsSinceEpoch() == rhs.getMicroSecondsSinceEpoch();
+}
+
+// 两个时间戳的差值（单位：秒）
+inline double timeDifference(TimeStamp high, TimeStamp low) {
+    int64_t diff = high.getMicroSecondsSinceEpoch() - low.getMicroSecondsSinceEpoch();
+    return static_cast<double>(diff) / TimeStamp::kMicroSecondsPerSecond;
+}
+
+// 在时间戳上增加seconds秒（支持小数，精度到微秒）
+inline TimeStamp addTime(TimeStamp timestamp, double seconds) {
+    int64_t delta = static_cast<int64_t>(seconds * TimeStamp::kMicroSecondsPerSecond);
+    return TimeStamp(timestamp.getMicroSecondsSinceEpoch() + delta);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+
+#include "Callbacks.h"
+#include "NonCopyable.h"
+#include "TimeStamp.h"
+
+// 定时器：封装到期时间、回调函数以及重复间隔，由TimerQueue统一管理
+class Timer : NonCopyable {
+public:
+    Timer(TimerCallback cb, TimeStamp when, double interval) :
+        callback_(std::move(cb)), expiration_(when), interval_(interval), repeat_(interval > 0.0), sequence_(++numCreated_) {}
+
+    void run() const { callback_(); }  // 执行定时器回调
+
+    TimeStamp expiration() const { return expiration_; }
+    bool repeat() const { return repeat_; }
+    int64_t sequence() const { return sequence_; }
+
+    // 重复定时器重新计算下一次到期时间
+    void restart(TimeStamp now);
+
+    static int64_t numCreated() { return numCreated_; }
+
+private:
+    // ==== 定时器属性 ====
+    const TimerCallback callback_;  // 到期回调
+    TimeStamp expiration_;  // 到期时间
+    const double interval_;  // 重复间隔（秒），<=0 表示一次性定时器
+    const bool repeat_;  // 是否重复
+    const int64_t sequence_;  // 全局唯一序号，用于区分地址复用的Timer对象
+
+    // ==== 类共享状态 ====
+    static std::atomic<int64_t> numCreated_;  // 已创建的定时器数量
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+class Timer;
+
+// 定时器句柄：对外暴露用于取消定时器，可拷贝
+// 使用 Timer 指针 + 序号共同标识，避免 Timer 释放后地址复用导致误删
+class TimerId {
+public:
+    TimerId() : timer_(nullptr), sequence_(0) {}
+    TimerId(Timer* timer, int64_t seq) : timer_(timer), sequence_(seq) {}
+
+    friend class TimerQueue;
+
+private:
+    Timer* timer_;
+    int64_t sequence_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "Callbacks.h"
+#include "Channel.h"
+#include "NonCopyable.h"
+#include "TimeStamp.h"
+#include "TimerId.h"
+
+class EventLoop;
+class Timer;
+
+/**
+ * 定时器队列：每个EventLoop持有一个
+ * 底层使用timerfd，把定时器事件当作普通的IO事件注册到Poller中，
+ * timerfd总是设置为最早到期的定时器时间；到期后一次性取出所有过期定时器批量执行。
+ * 插入/取消均为 O(log n)（std::set）。
+ **/
+class TimerQueue : NonCopyable {
+public:
+    explicit TimerQueue(EventLoop* loop);
+    ~TimerQueue();
+
+    // 线程安全：可在其他线程调用，内部转到loop线程执行
+    TimerId addTimer(TimerCallback cb, TimeStamp when, double interval);
+    void cancel(TimerId timerId);
+
+private:
+    // 以 (到期时间, Timer*) 作为key，保证到期时间相同的定时器也能共存
+    using Entry = std::pair<TimeStamp, Timer*>;
+    using TimerList = std::set<Entry>;
+    // 以 (Timer*, 序号) 作为key，用于取消定时器
+    using ActiveTimer = std::pair<Timer*, int64_t>;
+    using ActiveTimerSet = std::set<ActiveTimer>;
+
+    // ==== 核心组件 ====
+    EventLoop* loop_;  // 所属事件循环
+    const int timerfd_;  // timerfd
+    Channel timerfdChannel_;  // 监听timerfd的Channel
+
+    // ==== 定时器集合 ====
+    TimerList timers_;  // 按到期时间排序
+    ActiveTimerSet activeTimers_;  // 按Timer地址排序，与timers_保存相同的定时器
+
+    // ==== 回调执行期间的取消处理 ====
+    bool callingExpiredTimers_;  // 是否正在执行到期回调
+    ActiveTimerSet cancelingTimers_;  // 回调执行期间被取消的定时器
+
+    // ==== 内部方法 ====
+    void addTimerInLoop(Timer* timer);
+    void cancelInLoop(TimerId timerId);
+    void handleRead();  // timerfd可读时执行到期回调
+    std::vector<Entry> getExpired(TimeStamp now);  // 移除并返回所有已到期的定时器
+    void reset(const std::vector<Entry>& expired, TimeStamp now);  // 重启重复定时器并重新设置timerfd
+    bool insert(Timer* timer);  // 插入定时器，返回是否成为最早到期的定时器
+};
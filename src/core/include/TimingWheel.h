@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "NonCopyable.h"
+#include "TimerId.h"
+
+class EventLoop;
+
+/**
+ * 每个EventLoop一个的哈希时间轮，为大量连接的空闲超时计时，代替每个连接一个堆定时器。
+ *  - 时间按tick离散，第t个tick处理槽 t % slots 中的超时项
+ *  - touch只把当前tick记到超时项上，O(1)且不移动任何数据
+ *  - 槽被处理时才按 最近touch + 超时 重新计算到期tick：未到期的挪到到期tick所在的槽，到期的调用回调
+ *  - 超时超过一圈的项每圈被检查一次，相当于分层时间轮中上层轮的作用
+ * 只在所属loop线程使用；槽中有项时才按tick运行定时器，全部到期或丢弃后停止，下次add时重新开始。
+ * 超时项可以比时间轮存活更久（如连接晚于loop析构）：项共享tick计数，时间轮析构后touch不再有效果，也不会访问时间轮。
+ **/
+class TimingWheel : NonCopyable {
+public:
+    using Callback = std::function<void()>;
+
+    class Entry : NonCopyable {
+    public:
+        void touch() { lastTouch_ = *clock_; }  // 重新开始计时
+        void cancel() {  // 取消后不再调用回调，槽中的项在下次被处理时丢弃
+            cancelled_ = true;
+            callback_ = nullptr;
+        }
+        bool expired() const { return expired_; }
+
+    private:
+        friend class TimingWheel;
+        Entry(std::shared_ptr<const uint64_t> clock, uint64_t timeoutTicks, Callback cb) :
+            clock_(std::move(clock)), lastTouch_(*clock_), timeoutTicks_(timeoutTicks), callback_(std::move(cb)), cancelled_(false), expired_(false) {}
+
+        std::shared_ptr<const uint64_t> clock_;  // 所属时间轮的tick计数，与时间轮共同持有
+        uint64_t lastTouch_;  // 最近一次touch时的tick
+        uint64_t timeoutTicks_;
+        Callback callback_;
+        bool cancelled_;
+        bool expired_;
+    };
+    using EntryPtr = std::shared_ptr<Entry>;
+
+    static constexpr double kDefaultTick = 1.0;  // 秒
+    static const size_t kDefaultSlots = 512;  // 一圈约8.5分钟
+
+    explicit TimingWheel(EventLoop* loop, double tick = kDefaultTick, size_t slots = kDefaultSlots);
+    ~TimingWheel();
+
+    // timeout秒内没有touch则调用cb（只调用一次，在loop线程）；实际触发时间在[timeout, timeout + 2 * tick)之间
+    EntryPtr add(double timeout, Callback cb);
+
+    double tick() const { return tick_; }
+    size_t size() const { return size_; }  // 槽中尚未丢弃的超时项数
+    bool ticking() const { return ticking_; }  // tick定时器是否在运行
+
+private:
+    void onTick();
+    void place(const EntryPtr& entry, uint64_t deadline);
+
+    EventLoop* loop_;
+    const double tick_;
+    std::vector<std::vector<EntryPtr>> slots_;
+    std::shared_ptr<uint64_t> now_;  // 已经过的tick数
+    size_t size_;
+    bool ticking_;
+    TimerId timerId_;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Callbacks.h"
+#include "InetAddress.h"
+#include "NonCopyable.h"
+#include "TimeStamp.h"
+#include "TimerId.h"
+
+class EventLoop;
+class TcpClient;
+
+/**
+ * 每个loop一个的上游连接池，按"ip:port"分组复用到后端的TcpConnection，避免每个请求都重新建连。
+ * 所有接口都只能在所属loop线程调用，无锁。
+ *  - acquire：选择在途请求数(inflight)最少的已连接成员；最少的也在忙且未达到上限时新建连接，建好前请求排队
+ *  - release：请求结束后归还，超出空闲上限的连接直接关闭
+ *  - 定时巡检：关闭空闲超时的连接，对空闲连接执行健康检查，失败则关闭
+ * 连接被对端关闭时自动从池中移除，正在使用它的调用方会在自己的消息/连接回调中感知到。
+ **/
+class UpstreamPool : NonCopyable {
+public:
+    using AcquireCallback = std::function<void(const TcpConnectionPtr&)>;  // 失败时参数为nullptr
+    using HealthCheck = std::function<bool(const TcpConnectionPtr&)>;  // 返回false表示连接不健康
+
+    UpstreamPool(EventLoop* loop, const std::string& nameArg);
+    ~UpstreamPool();
+
+    void setMaxConnectionsPerUpstream(size_t n) { maxConnections_ = n; }
+    void setMaxIdlePerUpstream(size_t n) { maxIdle_ = n; }
+    void setIdleTimeout(double seconds) { idleTimeout_ = seconds; }
+    void setConnectTimeout(double seconds) { connectTimeout_ = seconds; }
+    void setConnectRetries(int retries) { connectRetries_ = retries; }
+    // 巡检周期（秒）与可选的健康检查函数，首次acquire时启动定时器
+    void setHealthCheck(double intervalSeconds, const HealthCheck& check) {
+        checkInterval_ = intervalSeconds;
+        healthCheck_ = check;
+    }
+    // 池中所有连接共用的消息回调（上游的响应）
+    void setMessageCallback(const MessageCallback& cb) { messageCallback_ = cb; }
+
+    void acquire(const InetAddress& upstream, const AcquireCallback& cb);
+    void release(const TcpConnectionPtr& conn);
+
+    size_t connectionCount(const InetAddress& upstream) const;  // 已建立的连接数
+    size_t idleCount(const InetAddress& upstream) const;  // inflight为0的已建立连接数
+    size_t inflight(const TcpConnectionPtr& conn) const;
+
+    static const size_t kDefaultMaxConnections = 8;
+    static const size_t kDefaultMaxIdle = 4;
+
+private:
+    struct Member {
+        std::unique_ptr<TcpClient> client;
+        TcpConnectionPtr conn;  // 连接建立前为空
+        size_t inflight = 0;
+        TimeStamp idleSince;
+        bool closing = false;  // 已发起关闭，不再分配
+    };
+    struct Upstream {
+        InetAddress addr;
+        std::vector<std::unique_ptr<Member>> members;
+        std::deque<AcquireCallback> waiters;  // 等待新连接建立的请求
+        size_t connecting = 0;
+    };
+
+    Upstream* find(const std::string& key);
+    const Upstream* find(const std::string& key) const;
+    Member* leastInflight(Upstream& up);
+    Member* findMember(Upstream& up, const TcpConnectionPtr& conn);
+    void openConnection(const std::string& key, Upstream& up);
+    void onConnection(const std::string& key, Member* member, const TcpConnectionPtr& conn);
+    void onConnectFailed(const std::string& key, Member* member);
+    void removeMember(const std::string& key, Member* member);
+    void dispatchWaiters(const std::string& key, Upstream& up);
+    void closeMember(Member* member);
+    static bool isIdle(const Member& member);
+    void checkIdle();
+
+    EventLoop* loop_;
+    const std::string name_;
+    std::unordered_map<std::string, Upstream> upstreams_;
+    MessageCallback messageCallback_;
+    HealthCheck healthCheck_;
+
+    size_t maxConnections_;
+    size_t maxIdle_;
+    double idleTimeout_;
+    double connectTimeout_;
+    int connectRetries_;
+    double checkInterval_;
+    bool checking_;  // 巡检定时器是否已启动
+    TimerId checkTimer_;
+    int nextClientId_;
+};
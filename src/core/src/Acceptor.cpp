@@ -1,10 +1,12 @@
 #include "Acceptor.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "EventLoop.h"
 #include "InetAddress.h"
 #include "Logger.h"
 
@@ -20,19 +22,36 @@ Acceptor::Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reusePor
     loop_(loop),  // 初始化事件循环指针
     acceptSocket_(createNonBlockingSocket()),  // 创建非阻塞监听套接字
     acceptChannel_(loop, acceptSocket_.getSocketFd()),  // 创建监听通道
-    listenning_(false)  // 初始状态未开始监听
+    listenning_(false),  // 初始状态未开始监听
+    idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)),  // 预留一个fd
+    alive_(std::make_shared<bool>(true))
 {
     acceptSocket_.setReuseAddr(true);  // 设置SO_REUSEADDR选项（快速重启）
     acceptSocket_.setReusePort(reusePort);  // 设置SO_REUSEPORT选项（多线程监听同一端口）
     acceptSocket_.bindAddress(listenAddr);  // 绑定监听地址（IP+Port）
     // TcpServer::start() => Acceptor.listen() 如果有新用户连接 要执行一个回调(accept => connfd => 打包成Channel => 唤醒subloop)
     // baseloop监听到有事件发生 => acceptChannel_(listenfd) => 执行该回调函数
-    acceptChannel_.setReadCallback([this](TimeStamp t) { this->handleRead(); });
+    acceptChannel_.setReadCallback([this](TimeStamp) { this->handleRead(); });
+}
+
+Acceptor::Acceptor(EventLoop* loop, int listenFd) :
+    loop_(loop),
+    acceptSocket_(listenFd),
+    acceptChannel_(loop, listenFd),
+    listenning_(false),
+    idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)),
+    alive_(std::make_shared<bool>(true))
+{
+    acceptChannel_.setReadCallback([this](TimeStamp) { this->handleRead(); });
 }
 
 Acceptor::~Acceptor() {
+    loop_->cancel(retryTimer_);
     acceptChannel_.disableAll();  // 把从Poller中感兴趣的事件删除掉
     acceptChannel_.remove();  // 调用EventLoop->removeChannel => Poller->removeChannel 把Poller的ChannelMap对应的部分删除
+    if (idleFd_ >= 0) {
+        ::close(idleFd_);
+    }
 }
 
 void Acceptor::listen() {
@@ -41,19 +60,88 @@ void Acceptor::listen() {
     acceptChannel_.enableReading();  // 核心操作：将acceptChannel_注册到Poller
 }
 
+// 每次事件循环accept直到EAGAIN，最多kMaxAcceptsPerEvent个，攒成一批交给上层，由上层按目标loop批量转交
+// LT模式下剩余的连接下次poll会再次就绪；ET模式不会再通知，达到上限时让出loop，本轮末尾继续
 void Acceptor::handleRead() {
-    InetAddress peerAddr;
-    int connfd = acceptSocket_.accept(&peerAddr);
-    if (connfd >= 0) {
-        if (NewConnectionCallback_) {
-            NewConnectionCallback_(connfd, peerAddr);
-        } else {
-            ::close(connfd);
+    batch_.clear();
+    bool drained = false;
+    bool paused = false;
+    for (int accepts = 0; accepts < kMaxAcceptsPerEvent; ++accepts) {
+        InetAddress peerAddr;
+        int connfd = acceptSocket_.accept(&peerAddr);
+        if (connfd >= 0) {
+            batch_.push_back(AcceptedSocket{connfd, peerAddr});
+            continue;
         }
-    } else {
-        LOG_ERROR("%s:%s:%d accept err:%d\n", __FILE__, __FUNCTION__, __LINE__, errno);
-        if (errno == EMFILE) {
+        int savedErrno = errno;
+        if (savedErrno == EMFILE || savedErrno == ENFILE) {
+            // 不处理的话监听fd持续可读，loop空转；借用预留fd接受后立即关闭，对端收到FIN，继续处理积压的连接
             LOG_ERROR("%s:%s:%d sockfd reached limit\n", __FILE__, __FUNCTION__, __LINE__);
+            if (!shedConnection()) {
+                // 连预留fd都没有，继续accept只会空转；暂停监听，稍后重试
+                paused = true;
+                break;
+            }
+            continue;
+        }
+        if (savedErrno != EAGAIN && savedErrno != EWOULDBLOCK && savedErrno != ECONNABORTED && savedErrno != EINTR) {
+            LOG_ERROR("%s:%s:%d accept err:%d\n", __FILE__, __FUNCTION__, __LINE__, savedErrno);
         }
+        drained = savedErrno == EAGAIN || savedErrno == EWOULDBLOCK;
+        break;
+    }
+
+    if (newConnectionBatchCallback_) {
+        if (!batch_.empty()) {
+            newConnectionBatchCallback_(batch_);
+        }
+    } else {
+        for (const AcceptedSocket& accepted : batch_) {
+            if (NewConnectionCallback_) {
+                NewConnectionCallback_(accepted.sockfd, accepted.peerAddr);
+            } else {
+                ::close(accepted.sockfd);
+            }
+        }
+    }
+    if (paused) {
+        pauseAccepting();
+    } else if (!drained && acceptChannel_.isEdgeTriggered()) {
+        // 任务执行前Acceptor可能已被销毁（停止监听、热升级交接），只持有弱引用
+        std::weak_ptr<bool> alive = alive_;
+        loop_->queueInLoop([this, alive]() {
+            if (alive.lock()) {
+                this->handleRead();
+            }
+        });
     }
-}
\ No newline at end of file
+}
+
+bool Acceptor::shedConnection() {
+    if (idleFd_ < 0) {  // 预留fd也没能重新打开，只能等待
+        return false;
+    }
+    ::close(idleFd_);
+    idleFd_ = ::accept(acceptSocket_.getSocketFd(), nullptr, nullptr);
+    if (idleFd_ >= 0) {
+        ::close(idleFd_);
+    }
+    idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return true;
+}
+
+void Acceptor::pauseAccepting() {
+    acceptChannel_.disableReading();
+    loop_->cancel(retryTimer_);
+    retryTimer_ = loop_->runAfter(kAcceptRetryDelay, [this]() { this->resumeAccepting(); });  // 析构时取消
+}
+
+// 重新关注监听fd；ET模式下兴趣改变会重新注册，期间积压的连接会再次报告
+void Acceptor::resumeAccepting() {
+    if (idleFd_ < 0) {
+        idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+    if (listenning_) {
+        acceptChannel_.enableReading();
+    }
+}
@@ -4,10 +4,153 @@
 #include <sys/uio.h>
 #include <unistd.h>
 
-// 从文件描述符读取数据到缓冲区（LT模式）
-// 使用readv实现高效读取：优先使用Buffer空间，不足时暂存到栈空间再以append的方式追加到buffer_
-ssize_t Buffer::readFd(int fd, int* saveErrno) {
-    char extrabuf[65536] = {0};  // 64KB栈空间备用缓冲区
+#include <cstring>
+
+#include "SlabPool.h"
+
+namespace {
+// 未传入暂存区时的后备（如直接使用Buffer的代码），线程局部，不随每次调用清零
+thread_local char t_scratch[65536];
+// 没有存储的Buffer指向这里：只有kCheapPrepend大小，可写空间为0，写入前一定会先分配
+char g_noStorage[Buffer::kCheapPrepend];
+}  // namespace
+
+Buffer::Buffer(size_t initalSize) :
+    buffer_(new char[kCheapPrepend + initalSize]),
+    capacity_(kCheapPrepend + initalSize),
+    pool_(nullptr),
+    readerIndex_(kCheapPrepend),
+    writerIndex_(kCheapPrepend),
+    readHint_(initalSize < kInitialSize ? kInitialSize : initalSize),
+    overflowReads_(0),
+    smallReads_(0) {}
+
+Buffer::Buffer(SlabPool* pool) :
+    buffer_(g_noStorage),
+    capacity_(kCheapPrepend),
+    pool_(pool),
+    readerIndex_(kCheapPrepend),
+    writerIndex_(kCheapPrepend),
+    readHint_(kInitialSize),
+    overflowReads_(0),
+    smallReads_(0) {}
+
+Buffer::~Buffer() {
+    if (!hasStorage()) {
+        return;
+    }
+    if (pool_) {
+        pool_->deallocate(buffer_, capacity_);  // 可能不在loop线程析构
+    } else {
+        delete[] buffer_;
+    }
+}
+
+Buffer::Buffer(const Buffer& other) :
+    buffer_(new char[kCheapPrepend + other.readableBytes()]),
+    capacity_(kCheapPrepend + other.readableBytes()),
+    pool_(nullptr),
+    readerIndex_(kCheapPrepend),
+    writerIndex_(kCheapPrepend + other.readableBytes()),
+    readHint_(other.readHint_),
+    overflowReads_(0),
+    smallReads_(0) {
+    ::memcpy(begin() + kCheapPrepend, other.peek(), other.readableBytes());
+}
+
+Buffer& Buffer::operator=(const Buffer& other) {
+    if (this != &other) {
+        Buffer copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+Buffer::Buffer(Buffer&& other) noexcept : Buffer(static_cast<SlabPool*>(nullptr)) {
+    swap(other);
+}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+void Buffer::swap(Buffer& other) noexcept {
+    std::swap(buffer_, other.buffer_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(pool_, other.pool_);
+    std::swap(readerIndex_, other.readerIndex_);
+    std::swap(writerIndex_, other.writerIndex_);
+    std::swap(readHint_, other.readHint_);
+    std::swap(overflowReads_, other.overflowReads_);
+    std::swap(smallReads_, other.smallReads_);
+}
+
+bool Buffer::hasStorage() const {
+    return buffer_ != g_noStorage;
+}
+
+void Buffer::freeStorage() {
+    if (!hasStorage()) {
+        return;
+    }
+    if (pool_) {
+        pool_->release(buffer_, capacity_);
+    } else {
+        delete[] buffer_;
+    }
+    buffer_ = g_noStorage;
+    capacity_ = kCheapPrepend;
+}
+
+void Buffer::reallocate(size_t capacity) {
+    if (pool_) {
+        capacity = SlabPool::roundUp(capacity);
+    }
+    char* storage = pool_ ? pool_->allocate(capacity) : new char[capacity];
+    size_t readable = readableBytes();
+    ::memcpy(storage + kCheapPrepend, peek(), readable);
+    freeStorage();
+    buffer_ = storage;
+    capacity_ = capacity;
+    readerIndex_ = kCheapPrepend;
+    writerIndex_ = kCheapPrepend + readable;
+}
+
+void Buffer::releaseStorage() {
+    if (readableBytes() == 0) {
+        freeStorage();
+        retrieveAll();
+    }
+}
+
+void Buffer::shrinkToFit() {
+    size_t readable = readableBytes();
+    if (readable == 0) {
+        releaseStorage();
+        return;
+    }
+    size_t needed = kCheapPrepend + readable;
+    size_t target = pool_ ? SlabPool::roundUp(needed) : needed;
+    if (target < capacity_) {
+        reallocate(target);
+    }
+}
+
+// 从文件描述符读取数据到缓冲区
+// 使用readv实现高效读取：优先使用Buffer空间，不足时暂存到scratch再以append的方式追加到buffer_
+ssize_t Buffer::readFd(int fd, int* saveErrno, size_t maxBytes, char* scratch, size_t scratchLen) {
+    if (scratch == nullptr) {
+        scratch = t_scratch;
+        scratchLen = sizeof(t_scratch);
+    }
+
+    // 空闲时归还突发流量撑大的空间
+    if (readableBytes() == 0 && capacity_ > kCheapPrepend + 4 * readHint_) {
+        releaseStorage();
+    }
+    // 按预读大小预留可写空间，让数据直接读进Buffer，省去从scratch的二次拷贝
+    ensureWritableBytes(std::min(readHint_, maxBytes));
 
     /**
      *struct iovec {
@@ -21,13 +164,13 @@ ssize_t Buffer::readFd(int fd, int* saveErrno) {
     // 设置iovec结构
     // 第一块缓冲区，指向可写空间
     vec[0].iov_base = begin() + writerIndex_;
-    vec[0].iov_len = writable;
-    // 第二块缓冲区，指向栈空间
-    vec[1].iov_base = extrabuf;
-    vec[1].iov_len = sizeof(extrabuf);
+    vec[0].iov_len = std::min(writable, maxBytes);
+    // 第二块缓冲区，指向暂存区
+    vec[1].iov_base = scratch;
+    vec[1].iov_len = std::min(scratchLen, maxBytes - vec[0].iov_len);
 
     // 根据剩余空间决定使用1个还是2个缓冲区
-    const int iovcnt = (writable < sizeof(extrabuf)) ? 2 : 1;
+    const int iovcnt = (writable < scratchLen && vec[1].iov_len > 0) ? 2 : 1;
     const ssize_t n = ::readv(fd, vec, iovcnt);
 
     if (n < 0) {
@@ -35,12 +178,35 @@ ssize_t Buffer::readFd(int fd, int* saveErrno) {
     } else if (n <= writable) {
         writerIndex_ += n;  // 全部数据存入Buffer
     } else {
-        writerIndex_ = buffer_.size();
-        append(extrabuf, n - writable);  // 追加栈空间数据
+        writerIndex_ = capacity_;
+        append(scratch, n - writable);  // 追加暂存区数据
+    }
+    if (n > 0) {
+        adaptReadHint(n);
     }
     return n;
 }
 
+// 连续超过预读大小说明消息普遍更大，翻倍；连续远小于预读大小说明连接变闲，减半
+void Buffer::adaptReadHint(size_t n) {
+    if (n > readHint_) {
+        smallReads_ = 0;
+        if (++overflowReads_ >= kGrowAfterOverflows) {
+            readHint_ = std::min(readHint_ * 2, kMaxReadHint);
+            overflowReads_ = 0;
+        }
+    } else if (n <= readHint_ / 4) {
+        overflowReads_ = 0;
+        if (++smallReads_ >= kShrinkAfterSmallReads) {
+            readHint_ = std::max(readHint_ / 2, kInitialSize);
+            smallReads_ = 0;
+        }
+    } else {
+        overflowReads_ = 0;
+        smallReads_ = 0;
+    }
+}
+
 // 将缓冲区数据写入文件描述符
 ssize_t Buffer::writeFd(int fd, int* saveErrno) {
     ssize_t n = ::write(fd, peek(), readableBytes());
@@ -0,0 +1,173 @@
+#include "ChainBuffer.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "SlabPool.h"
+
+namespace {
+const int kMaxIovecs = IOV_MAX;
+const size_t kMaxRetainedEntries = 16;  // 清空时链表容量超过该值则一并释放
+}  // namespace
+
+ChainBuffer::ChainBuffer(SlabPool* pool) : pool_(pool), head_(0), readable_(0) {}
+
+ChainBuffer::~ChainBuffer() {
+    for (size_t i = head_; i < slabs_.size(); ++i) {
+        if (slabs_[i].shared) {
+            continue;
+        }
+        if (pool_) {
+            pool_->deallocate(slabs_[i].data, kSlabSize);  // 可能不在loop线程析构
+        } else {
+            delete[] slabs_[i].data;
+        }
+    }
+}
+
+char* ChainBuffer::allocateSlab() {
+    return pool_ ? pool_->allocate(kSlabSize) : new char[kSlabSize];
+}
+
+void ChainBuffer::releaseSlab(char* data) {
+    if (pool_) {
+        pool_->release(data, kSlabSize);
+    } else {
+        delete[] data;
+    }
+}
+
+void ChainBuffer::releaseSegment(Slab& slab) {
+    if (slab.shared) {
+        slab.shared.reset();
+    } else {
+        releaseSlab(slab.data);
+    }
+}
+
+void ChainBuffer::append(const char* data, size_t len) {
+    readable_ += len;
+    while (len > 0) {
+        if (slabCount() == 0 || slabs_.back().shared || slabs_.back().writeIndex == kSlabSize) {
+            slabs_.push_back(Slab{allocateSlab(), 0, 0, nullptr});
+        }
+        Slab& tail = slabs_.back();
+        size_t n = std::min(len, kSlabSize - tail.writeIndex);
+        ::memcpy(tail.data + tail.writeIndex, data, n);
+        tail.writeIndex += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void ChainBuffer::appendShared(const SharedSlice& slice) {
+    if (slice.empty()) {
+        return;
+    }
+    readable_ += slice.size();
+    slabs_.push_back(Slab{const_cast<char*>(slice.data()), 0, slice.size(), slice.storage()});
+}
+
+// 从后往前填：先用头部slab前面的空间，再在链头挂新slab，数据放在新slab的末尾
+void ChainBuffer::prepend(const char* data, size_t len) {
+    readable_ += len;
+    while (len > 0) {
+        if (slabCount() == 0 || slabs_[head_].shared || slabs_[head_].readIndex == 0) {
+            Slab slab{allocateSlab(), kSlabSize, kSlabSize, nullptr};
+            if (head_ > 0) {
+                slabs_[--head_] = slab;
+            } else {
+                slabs_.insert(slabs_.begin(), slab);
+            }
+        }
+        Slab& head = slabs_[head_];
+        size_t n = std::min(len, head.readIndex);
+        head.readIndex -= n;
+        ::memcpy(head.data + head.readIndex, data + len - n, n);
+        len -= n;
+    }
+}
+
+void ChainBuffer::retrieve(size_t len) {
+    len = std::min(len, readable_);
+    readable_ -= len;
+    while (len > 0) {
+        Slab& head = slabs_[head_];
+        size_t n = std::min(len, head.writeIndex - head.readIndex);
+        head.readIndex += n;
+        len -= n;
+        if (head.readIndex == head.writeIndex) {
+            releaseSegment(head);
+            ++head_;
+        }
+    }
+    if (readable_ == 0) {
+        retrieveAll();
+    } else if (head_ > kMaxRetainedEntries && head_ * 2 >= slabs_.size()) {
+        // 持续边写边发时链表前部积累的空位，过半时整体前移
+        slabs_.erase(slabs_.begin(), slabs_.begin() + head_);
+        head_ = 0;
+    }
+}
+
+void ChainBuffer::retrieveAll() {
+    for (size_t i = head_; i < slabs_.size(); ++i) {
+        releaseSegment(slabs_[i]);
+    }
+    if (slabs_.capacity() > kMaxRetainedEntries) {
+        std::vector<Slab>().swap(slabs_);
+    } else {
+        slabs_.clear();
+    }
+    head_ = 0;
+    readable_ = 0;
+}
+
+std::string ChainBuffer::retrieveAllAsString() {
+    std::string result;
+    result.reserve(readable_);
+    for (size_t i = head_; i < slabs_.size(); ++i) {
+        result.append(slabs_[i].data + slabs_[i].readIndex, slabs_[i].writeIndex - slabs_[i].readIndex);
+    }
+    retrieveAll();
+    return result;
+}
+
+SharedSlice ChainBuffer::frontShared() const {
+    if (slabCount() == 0 || !slabs_[head_].shared) {
+        return SharedSlice();
+    }
+    const Slab& head = slabs_[head_];
+    size_t offset = head.data + head.readIndex - head.shared->data();
+    return SharedSlice(head.shared, offset, head.writeIndex - head.readIndex);
+}
+
+ssize_t ChainBuffer::writeFd(int fd, int* saveErrno, size_t maxBytes) {
+    struct iovec vec[kMaxIovecs];
+    int iovcnt = 0;
+    size_t total = 0;
+    for (size_t i = head_; i < slabs_.size(); ++i) {
+        const Slab& slab = slabs_[i];
+        if (iovcnt == kMaxIovecs || total >= maxBytes) {
+            break;
+        }
+        size_t len = std::min(slab.writeIndex - slab.readIndex, maxBytes - total);
+        vec[iovcnt].iov_base = slab.data + slab.readIndex;
+        vec[iovcnt].iov_len = len;
+        ++iovcnt;
+        total += len;
+    }
+    if (iovcnt == 0) {
+        return 0;
+    }
+    ssize_t n = (iovcnt == 1) ? ::write(fd, vec[0].iov_base, vec[0].iov_len) : ::writev(fd, vec, iovcnt);
+    if (n < 0) {
+        *saveErrno = errno;
+    }
+    return n;
+}
@@ -10,7 +10,7 @@ const int Channel::kNoneEvent = 0;  // 空事件
 const int Channel::kReadEvent = EPOLLIN | EPOLLPRI;  // 读事件
 const int Channel::kWriteEvent = EPOLLOUT;  // 写事件
 
-Channel::Channel(EventLoop* loop, int fd) : loop_(loop), fd_(fd), events_(0), revents_(0), index_(-1), tied_(false) {}
+Channel::Channel(EventLoop* loop, int fd) : loop_(loop), fd_(fd), events_(0), revents_(0), edgeTriggered_(false), tied_(false) {}
 Channel::~Channel() {}
 
 // Channel的tie方法调用时机:TcpConnection => Channel
@@ -28,7 +28,7 @@ void Channel::update() {
     loop_->updateChannel(this);
 }
 void Channel::remove() {
-    loop_->updateChannel(this);
+    loop_->removeChannel(this);
 }
 
 void Channel::handleEvent(TimeStamp receiveTime) {
@@ -0,0 +1,211 @@
+#include "Connector.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "Channel.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "Socket.h"
+
+Connector::Connector(EventLoop* loop, const InetAddress& serverAddr) :
+    loop_(loop),
+    serverAddr_(serverAddr),
+    connect_(false),
+    state_(kDisconnected),
+    initRetryDelay_(kDefaultInitRetryDelay),
+    maxRetryDelay_(kDefaultMaxRetryDelay),
+    retryDelay_(kDefaultInitRetryDelay),
+    connectTimeout_(0),
+    maxRetries_(-1),
+    retries_(0)
+{
+}
+
+Connector::~Connector() {
+    // 连接中的channel由stop释放；析构时仍在连接说明使用者没有stop，只能关闭fd
+    if (channel_) {
+        LOG_ERROR("Connector::~Connector [%s] - destroyed while connecting\n", serverAddr_.toIpPort().c_str());
+        ::close(channel_->getFd());
+    }
+}
+
+void Connector::start() {
+    connect_ = true;
+    loop_->runInLoop([self = shared_from_this()]() { self->startInLoop(); });
+}
+
+void Connector::restart() {
+    setState(kDisconnected);
+    retryDelay_ = initRetryDelay_;
+    retries_ = 0;
+    connect_ = true;
+    startInLoop();
+}
+
+void Connector::stop() {
+    connect_ = false;
+    loop_->queueInLoop([self = shared_from_this()]() { self->stopInLoop(); });
+}
+
+void Connector::startInLoop() {
+    if (state_ != kDisconnected) {
+        return;
+    }
+    if (connect_) {
+        connect();
+    }
+}
+
+void Connector::stopInLoop() {
+    cancelTimers();
+    if (state_ == kConnecting) {
+        setState(kDisconnected);
+        int sockfd = removeAndResetChannel();
+        ::close(sockfd);
+    }
+}
+
+void Connector::connect() {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (sockfd < 0) {
+        LOG_ERROR("Connector::connect - socket create err:%d\n", errno);
+        retry(-1);
+        return;
+    }
+    int ret = ::connect(sockfd, (sockaddr*) serverAddr_.getSockAddr(), sizeof(sockaddr_in));
+    int savedErrno = (ret == 0) ? 0 : errno;
+    switch (savedErrno) {
+        case 0:
+        case EINPROGRESS:
+        case EINTR:
+        case EISCONN:
+            connecting(sockfd);
+            break;
+
+        // 暂时性错误（端口耗尽、对端未监听、网络不可达等），退避后重试
+        case EAGAIN:
+        case EADDRINUSE:
+        case EADDRNOTAVAIL:
+        case ECONNREFUSED:
+        case ENETUNREACH:
+        case EHOSTUNREACH:
+        case ETIMEDOUT:
+            retry(sockfd);
+            break;
+
+        // 参数或权限错误，重试也不会成功
+        default:
+            LOG_ERROR("Connector::connect [%s] - connect error:%d %s\n", serverAddr_.toIpPort().c_str(), savedErrno, ::strerror(savedErrno));
+            ::close(sockfd);
+            connect_ = false;
+            if (connectFailedCallback_) {
+                connectFailedCallback_();
+            }
+            break;
+    }
+}
+
+void Connector::connecting(int sockfd) {
+    setState(kConnecting);
+    channel_.reset(new Channel(loop_, sockfd));
+    channel_->setWriteCallback([this]() { this->handleWrite(); });
+    channel_->setErrorCallback([this]() { this->handleError(); });
+    channel_->enableWriting();  // 连接完成（成功或失败）时socket变为可写
+
+    if (connectTimeout_ > 0) {
+        std::weak_ptr<Connector> weakSelf = shared_from_this();
+        timeoutTimer_ = loop_->runAfter(connectTimeout_, [weakSelf]() {
+            if (ConnectorPtr self = weakSelf.lock()) {
+                self->handleTimeout();
+            }
+        });
+    }
+}
+
+int Connector::removeAndResetChannel() {
+    channel_->disableAll();
+    channel_->remove();
+    int sockfd = channel_->getFd();
+    // 可能正处于channel_自己的回调中，延迟到本轮pending functors再释放
+    std::shared_ptr<Channel> dying(channel_.release());
+    loop_->queueInLoop([dying]() {});
+    return sockfd;
+}
+
+void Connector::handleWrite() {
+    if (state_ != kConnecting) {
+        return;
+    }
+    int sockfd = removeAndResetChannel();
+    loop_->cancel(timeoutTimer_);
+    int err = Socket::getSocketError(sockfd);
+    if (err) {
+        LOG_WARN("Connector::handleWrite [%s] - SO_ERROR = %d %s\n", serverAddr_.toIpPort().c_str(), err, ::strerror(err));
+        retry(sockfd);
+    } else if (Socket::isSelfConnect(sockfd)) {
+        LOG_WARN("Connector::handleWrite [%s] - self connect\n", serverAddr_.toIpPort().c_str());
+        retry(sockfd);
+    } else {
+        setState(kConnected);
+        if (connect_) {
+            newConnectionCallback_(sockfd);
+        } else {
+            ::close(sockfd);
+        }
+    }
+}
+
+void Connector::handleError() {
+    if (state_ == kConnecting) {
+        int sockfd = removeAndResetChannel();
+        loop_->cancel(timeoutTimer_);
+        int err = Socket::getSocketError(sockfd);
+        LOG_WARN("Connector::handleError [%s] - SO_ERROR = %d %s\n", serverAddr_.toIpPort().c_str(), err, ::strerror(err));
+        retry(sockfd);
+    }
+}
+
+void Connector::handleTimeout() {
+    if (state_ == kConnecting) {
+        LOG_WARN("Connector::handleTimeout [%s] - connect timed out after %.3fs\n", serverAddr_.toIpPort().c_str(), connectTimeout_);
+        int sockfd = removeAndResetChannel();
+        retry(sockfd);
+    }
+}
+
+void Connector::retry(int sockfd) {
+    if (sockfd >= 0) {
+        ::close(sockfd);
+    }
+    setState(kDisconnected);
+    if (!connect_) {
+        return;
+    }
+    if (maxRetries_ >= 0 && retries_ >= maxRetries_) {
+        LOG_ERROR("Connector::retry [%s] - giving up after %d retries\n", serverAddr_.toIpPort().c_str(), retries_);
+        connect_ = false;
+        if (connectFailedCallback_) {
+            connectFailedCallback_();
+        }
+        return;
+    }
+    ++retries_;
+    LOG_INFO("Connector::retry [%s] - retry #%d in %.3fs\n", serverAddr_.toIpPort().c_str(), retries_, retryDelay_);
+    std::weak_ptr<Connector> weakSelf = shared_from_this();
+    retryTimer_ = loop_->runAfter(retryDelay_, [weakSelf]() {
+        if (ConnectorPtr self = weakSelf.lock()) {
+            self->startInLoop();
+        }
+    });
+    retryDelay_ = std::min(retryDelay_ * 2, maxRetryDelay_);
+}
+
+void Connector::cancelTimers() {
+    loop_->cancel(timeoutTimer_);
+    loop_->cancel(retryTimer_);
+}
@@ -7,13 +7,7 @@
 #include "Channel.h"
 #include "Logger.h"
 
-enum {
-    kNew = -1,  // Channel成员index_初始化为-1，此时表示还未添加至Poller
-    kAdded = 1,  // 已添加
-    kDeleted = 2  // 已删除
-};
-
-EPollPoller::EPollPoller(EventLoop* loop) : Poller(loop), epollfd_(::epoll_create1(EPOLL_CLOEXEC)), events_(kInitEventListSize) {
+EPollPoller::EPollPoller(EventLoop* loop) : Poller(loop), epollfd_(::epoll_create1(EPOLL_CLOEXEC)), events_(kInitEventListSize), pendingUpdates_(0) {
     if (epollfd_ < 0) {
         LOG_FATAL("epoll_create error:%d \n", errno);
     }
@@ -26,11 +20,12 @@ EPollPoller::~EPollPoller() {
 TimeStamp EPollPoller::poll(int timeoutMs, ChannelList* activeChannels) {
     // 由于频繁调用poll 当遇到并发场景 关闭DEBUG日志提升效率
     // LOG_INFO("func = %s => fd total count: %lu\n", __FUNCTION__, channels_.size());
+    flushUpdates();
     int numEvents = ::epoll_wait(epollfd_, &*events_.begin(), static_cast<int>(events_.size()), timeoutMs);
     int saveErrno = errno;
     TimeStamp now(TimeStamp::now());
     if (numEvents > 0) {
-        LOG_INFO("%d events happend\n", numEvents);
+        LOG_DEBUG("%d events happend\n", numEvents);  // 每次poll的事件数由EventLoopMetrics统计
         fillActiveChannels(numEvents, activeChannels);
         if (numEvents == events_.size()) {
             events_.resize(events_.size() * 2);
@@ -53,40 +48,85 @@ TimeStamp EPollPoller::poll(int timeoutMs, ChannelList* activeChannels) {
 //  A[Channel.update/remove] --> B[EventLoop.updateChannel/removeChannel]
 //  B --> C[EPollPoller.updateChannel/removeChannel]
 // ```
+// updateChannel只把fd记为dirty，下次epoll_wait之前统一提交：同一轮中enableWriting+disableWriting互相抵消，
+// 多次修改只产生一次epoll_ctl。事件只在epoll_wait时产生，推迟到此前提交不会漏掉事件。
+// 例外是边沿触发：EPOLL_CTL_MOD会让内核重新检查就绪状态，暂停读期间已到达的数据靠它再报告一次。
+// 同一轮中关闭又打开EPOLLIN时最终事件不变，但仍要MOD，否则这些数据不会再有边沿，连接停住。
 void EPollPoller::updateChannel(Channel* channel) {
-    const int index = channel->getIndex();
-    LOG_INFO("func = %s => fd = %d events = %d index = %d\n", __FUNCTION__, channel->getFd(), channel->getEvents(), index);
-
-    if (index == kNew || index == kDeleted) {  // channel还未在Poller中注册
-        if (index == kNew) {
-            int fd = channel->getFd();
-            channels_[fd] = channel;
-        } else {  // index == kDeleted
-            // 仅更新状态，无需操作channels_
-        }
-        channel->setIndex(kAdded);
-        update(EPOLL_CTL_ADD, channel);
-    } else {  // channel已经在Poller中注册过
-        int fd = channel->getFd();
-        if (channel->isNoneEvent()) {  // 为空事件，删除该fd
-            update(EPOLL_CTL_DEL, channel);
-            channel->setIndex(kDeleted);
-        } else {
-            update(EPOLL_CTL_MOD, channel);
-        }
+    int fd = channel->getFd();
+    ChannelEntry& entry = entryOf(fd);
+    if (entry.channel != channel) {  // 新的Channel（或fd被复用），之前的状态作废
+        entry = ChannelEntry();
+        entry.channel = channel;
+    }
+    LOG_DEBUG("func = %s => fd = %d events = %d state = %d\n", __FUNCTION__, fd, channel->getEvents(), entry.state);
+    if (channel->isEdgeTriggered() && entry.state == kAdded && interestOf(channel) != entry.registeredEvents) {
+        entry.rearm = true;
+    }
+    add(updatesRequested_, 1);
+    ++pendingUpdates_;
+    if (!entry.dirty) {
+        entry.dirty = true;
+        dirtyFds_.push_back(fd);
     }
 }
 
+// 删除必须立即生效：调用者随后会销毁Channel并关闭fd
 void EPollPoller::removeChannel(Channel* channel) {
     int fd = channel->getFd();
-    channels_.erase(fd);
+    LOG_DEBUG("func = %s => fd = %d", __FUNCTION__, fd);
+    ChannelEntry& entry = entryOf(fd);
+    if (entry.channel != channel) {
+        return;  // 不属于当前Poller管理的Channel
+    }
+    if (entry.state == kAdded) {
+        update(EPOLL_CTL_DEL, channel, 0);
+    }
+    entry = ChannelEntry();  // dirtyFds_中残留的fd在提交时因dirty为false被跳过
+}
+
+void EPollPoller::flushUpdates() {
+    uint64_t issued = 0;
+    for (int fd : dirtyFds_) {
+        ChannelEntry& entry = channels_[fd];
+        if (!entry.dirty) {
+            continue;
+        }
+        entry.dirty = false;
+        Channel* channel = entry.channel;
+        uint32_t events = interestOf(channel);
+        if (entry.state != kAdded) {  // channel还未在epoll中注册
+            if (events != 0) {
+                update(EPOLL_CTL_ADD, channel, events);
+                ++issued;
+                entry.state = kAdded;
+                entry.registeredEvents = events;
+            }
+        } else if (channel->isNoneEvent()) {  // 为空事件，从epoll中删除该fd，但保留在表中
+            update(EPOLL_CTL_DEL, channel, 0);
+            ++issued;
+            entry.state = kDeleted;
+        } else if (events != entry.registeredEvents || entry.rearm) {
+            update(EPOLL_CTL_MOD, channel, events);
+            ++issued;
+            entry.registeredEvents = events;
+        }
+        entry.rearm = false;
+    }
+    dirtyFds_.clear();
+    add(updatesSaved_, pendingUpdates_ - issued);  // 立即执行时每次updateChannel都是一次epoll_ctl
+    pendingUpdates_ = 0;
+}
 
-    LOG_INFO("func = %s => fd = %d", __FUNCTION__, fd);
-    int index = channel->getIndex();
-    if (index == kAdded) {
-        update(EPOLL_CTL_DEL, channel);
+uint32_t EPollPoller::interestOf(const Channel* channel) {
+    if (channel->isNoneEvent()) {
+        return 0;
+    }
+    uint32_t events = channel->getEvents();
+    if (channel->isEdgeTriggered()) {
+        events |= EPOLLET;
     }
-    channel->setIndex(kDeleted);
+    return events;
 }
 
 // 将 epoll_wait 返回的就绪事件填充到 activeChannels 中，供 EventLoop 处理。
@@ -100,12 +140,12 @@ void EPollPoller::fillActiveChannels(int numEvents, ChannelList* activeChannels)
     }
 }
 
-void EPollPoller::update(int operation, Channel* channel) {
+void EPollPoller::update(int operation, Channel* channel, uint32_t events) {
     epoll_event event;
     ::memset(&event, 0, sizeof(event));
     int fd = channel->getFd();
 
-    event.events = channel->getEvents();
+    event.events = events;
     event.data.fd = fd;
     event.data.ptr = channel;
     if (::epoll_ctl(epollfd_, operation, fd, &event) < 0) {
@@ -2,9 +2,14 @@
 
 #include <sys/eventfd.h>
 
+#include <algorithm>
+
 #include "Channel.h"
 #include "Logger.h"
 #include "Poller.h"
+#include "SlabPool.h"
+#include "TimerQueue.h"
+#include "TimingWheel.h"
 
 // 每个线程对应一个 EventLoop
 thread_local EventLoop* t_loopInThisThread = nullptr;
@@ -36,18 +41,31 @@ int createEventfd() {
 EventLoop::EventLoop() :
     looping_(false),
     quit_(false),
-    callingPendingFunctors_(false),
     threadId_(CurrentThread::tid()),
     poller_(Poller::newDefaultPoller(this)),
+    busyPollMaxUs_(0),
+    busyPollMinUs_(0),
+    spinWindowUs_(0),
+    spinPolls_(0),
+    spinHits_(0),
+    blockingPolls_(0),
+    timerQueue_(new TimerQueue(this)),
     wakeupFd_(createEventfd()),
-    wakeupChannel_(new Channel(this, wakeupFd_)) {
+    wakeupChannel_(new Channel(this, wakeupFd_)),
+    callingPendingFunctors_(false),
+    wakeupPending_(false),
+    functorBudget_(0),
+    functorsCarriedOver_(false),
+    scratchBuffer_(new char[kScratchBufferSize]),
+    slabPool_(new SlabPool()),
+    timingWheel_(new TimingWheel(this)) {
     LOG_DEBUG("EvnetLoop created %p in thread %d \n", this, threadId_);
     if (t_loopInThisThread == nullptr) {
         t_loopInThisThread = this;
     } else {
         LOG_FATAL("Another EventLoop %p exists in thread %d \n", t_loopInThisThread, threadId_);
     }
-    wakeupChannel_->setReadCallback([this](TimeStamp t) { this->handleRead(); });  // 设置 wakeupfd 的事件类型以及发生事件后的回调操作
+    wakeupChannel_->setReadCallback([this](TimeStamp) { this->handleRead(); });  // 设置 wakeupfd 的事件类型以及发生事件后的回调操作
     wakeupChannel_->enableReading();  // 每个 EventLoop 都监听 wakeupChannel_的EPOLL读事件
 }
 
@@ -55,25 +73,87 @@ EventLoop::~EventLoop() {
     wakeupChannel_->disableAll();  // 移除 Channel 中所有感兴趣的事件
     wakeupChannel_->remove();  // 将 Channel 从 EventLoop 上删除
     ::close(wakeupFd_);
+    while (PendingFunctor* task = pendingFunctors_.Pop()) {  // 丢弃loop退出后才投递、没有机会执行的回调
+        delete task;
+    }
     t_loopInThisThread = nullptr;
 }
 
 void EventLoop::loop() {
     looping_ = true;
-    quit_ = false;
+    // 不在开始时复位quit_：EventLoopThread::startLoop()返回后线程可能尚未进入loop()，此时的quit()不能丢失
     LOG_INFO("EventLoop %p start looping\n", this);
+    // 上一轮结束的时间即为本轮poll开始的时间，每轮只需额外取两次时间
+    int64_t iterationStart = TimeStamp::now().getMicroSecondsSinceEpoch();
     while (!quit_) {
         activeChannels_.clear();
-        pollReturnTime_ = poller_->poll(kPollTime, &activeChannels_);
+        if (functorsCarriedOver_) {  // 还有积压的回调，只取一次已就绪的事件，不等待
+            pollReturnTime_ = poller_->poll(0, &activeChannels_);
+        } else if (busyPollMaxUs_ > 0) {
+            pollReturnTime_ = busyPoll();
+        } else {
+            pollReturnTime_ = poller_->poll(kPollTime, &activeChannels_);
+        }
+        lastActiveChannels_.store(activeChannels_.size(), std::memory_order_relaxed);
         for (Channel* channel : activeChannels_) {
             channel->handleEvent(pollReturnTime_);  // Poller 监听事件，上报给 EventLoop通知 channel处理相应事件
         }
-        doPendingFunctors();
+        const int64_t pollReturn = pollReturnTime_.getMicroSecondsSinceEpoch();
+        const int64_t handled = TimeStamp::now().getMicroSecondsSinceEpoch();
+        size_t functors = doPendingFunctors();
+        const int64_t done = TimeStamp::now().getMicroSecondsSinceEpoch();
+        // 系统时间可能被回拨，负值按0记录
+        metrics_.recordIteration(std::max<int64_t>(pollReturn - iterationStart, 0), activeChannels_.size(), std::max<int64_t>(handled - pollReturn, 0), functors,
+                                 std::max<int64_t>(done - handled, 0));
+        iterationStart = done;
     }
     LOG_INFO("EventLoop %p stop looping\n", this);
+    quit_ = false;  // 本次quit()已生效，复位后可再次调用loop()
     looping_ = false;
 }
 
+void EventLoop::setBusyPoll(int64_t maxSpinUs, int64_t minSpinUs) {
+    busyPollMaxUs_ = maxSpinUs > 0 ? maxSpinUs : 0;
+    busyPollMinUs_ = std::min(std::max<int64_t>(minSpinUs, 0), busyPollMaxUs_);
+    spinWindowUs_.store(busyPollMaxUs_, std::memory_order_relaxed);
+}
+
+EventLoop::BusyPollStats EventLoop::busyPollStats() const {
+    return BusyPollStats{spinPolls_.load(std::memory_order_relaxed), spinHits_.load(std::memory_order_relaxed), blockingPolls_.load(std::memory_order_relaxed),
+                         spinWindowUs_.load(std::memory_order_relaxed)};
+}
+
+TimeStamp EventLoop::busyPoll() {
+    int64_t window = spinWindowUs_.load(std::memory_order_relaxed);
+    const int64_t start = TimeStamp::now().getMicroSecondsSinceEpoch();
+    TimeStamp now;
+    do {
+        now = poller_->poll(0, &activeChannels_);
+        if (!activeChannels_.empty()) {
+            // 自旋期间等到了事件：事件密集，扩大窗口
+            spinHits_.fetch_add(1, std::memory_order_relaxed);
+            spinWindowUs_.store(std::min(busyPollMaxUs_, std::max<int64_t>(window * 2, 1)), std::memory_order_relaxed);
+            return now;
+        }
+        spinPolls_.fetch_add(1, std::memory_order_relaxed);
+    } while (!quit_ && now.getMicroSecondsSinceEpoch() - start < window);
+
+    // 窗口内没有事件，进入内核阻塞等待
+    blockingPolls_.fetch_add(1, std::memory_order_relaxed);
+    const int64_t blockStart = now.getMicroSecondsSinceEpoch();
+    now = poller_->poll(kPollTime, &activeChannels_);
+    const int64_t gap = now.getMicroSecondsSinceEpoch() - blockStart;
+    if (!activeChannels_.empty() && gap <= busyPollMaxUs_) {
+        // 事件间隔落在预算内，多自旋一会儿就能避免这次阻塞：把窗口扩大到能覆盖该间隔
+        window = std::max(window * 2, gap);
+    } else {
+        // 事件稀疏，缩小窗口减少空转
+        window /= 2;
+    }
+    spinWindowUs_.store(std::min(busyPollMaxUs_, std::max(busyPollMinUs_, window)), std::memory_order_relaxed);
+    return now;
+}
+
 void EventLoop::quit() {
     quit_ = true;
     if (!isInLoopThread()) {
@@ -81,21 +161,14 @@ void EventLoop::quit() {
     }
 }
 
-void EventLoop::runInLoop(Functor cb) {
-    if (isInLoopThread()) {  // 在当前线程执行回调
-        cb();
-    } else {  // 非当前线程执行回调，唤醒EventLoop所在线程进行回调
-        queueInLoop(cb);
-    }
-}
-
-void EventLoop::queueInLoop(Functor cb) {
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        pendingFunctors_.emplace_back(cb);
-    }
+void EventLoop::enqueue(PendingFunctor* task) {
+    queuedFunctors_.fetch_add(1, std::memory_order_relaxed);  // 先计数再入队，取出时扣减不会出现负值
+    pendingFunctors_.Push(task);  // 无锁入队，链接字段在任务节点内，不再额外分配
     if (!isInLoopThread() || callingPendingFunctors_) {
-        wakeup();
+        // 已有未处理的唤醒时不再写eventfd：同一轮循环内N个生产者只需一次唤醒
+        if (!wakeupPending_.exchange(true, std::memory_order_acq_rel)) {
+            wakeup();
+        }
     }
 }
 
@@ -107,6 +180,33 @@ void EventLoop::wakeup() {
     }
 }
 
+TimerId EventLoop::runAt(TimeStamp time, TimerCallback cb) {
+    return timerQueue_->addTimer(std::move(cb), time, 0.0);
+}
+
+TimerId EventLoop::runAfter(double delay, TimerCallback cb) {
+    TimeStamp time(addTime(TimeStamp::now(), delay));
+    return runAt(time, std::move(cb));
+}
+
+TimerId EventLoop::runEvery(double interval, TimerCallback cb) {
+    TimeStamp time(addTime(TimeStamp::now(), interval));
+    return timerQueue_->addTimer(std::move(cb), time, interval);
+}
+
+void EventLoop::cancel(TimerId timerId) {
+    timerQueue_->cancel(timerId);
+}
+
+EventLoopMetrics::Snapshot EventLoop::metricsSnapshot() const {
+    EventLoopMetrics::Snapshot snap = metrics_.snapshot();
+    snap.interestUpdates = poller_->updatesRequested();
+    snap.interestUpdatesSaved = poller_->updatesSaved();
+    snap.bufferBytesInUse = slabPool_->bytesInUse();
+    snap.bufferBytesCached = slabPool_->bytesCached();
+    return snap;
+}
+
 void EventLoop::updateChannel(Channel* channel) {
     poller_->updateChannel(channel);
 }
@@ -120,22 +220,37 @@ bool EventLoop::hasChannel(Channel* channel) {
 }
 
 void EventLoop::handleRead() {
-    uint64_t one = 1;
-    ssize_t n = read(wakeupFd_, &one, sizeof(one));
-    if (n != sizeof(one)) {
+    uint64_t writes = 1;
+    ssize_t n = read(wakeupFd_, &writes, sizeof(writes));
+    if (n != sizeof(writes)) {
         LOG_ERROR("EventLoop::handleRead() writes %lu bytes instead of 8\n", n);
+        return;
     }
+    metrics_.recordWakeup(writes);  // eventfd计数值为上次读取以来wakeup()的次数
 }
 
-void EventLoop::doPendingFunctors() {
-    std::vector<Functor> functors;
+size_t EventLoop::doPendingFunctors() {
     callingPendingFunctors_ = true;
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        functors.swap(pendingFunctors_);  // 交换的方式减少了锁的临界区范围 提升效率 同时避免了死锁 如果执行functor()在临界区内 且functor()中调用queueInLoop()就会产生死锁
+    // 先清除唤醒标记再取队列：此后入队的生产者会重新唤醒，不会丢失通知
+    wakeupPending_.exchange(false, std::memory_order_acq_rel);
+    // 只取出当前已入队的回调再统一执行，执行期间新入队的回调留到下一轮，避免回调不断自我投递导致饿死其他事件
+    // 设置了预算时只取前functorBudget_个，其余留在队列中下一轮执行
+    const size_t limit = functorBudget_ > 0 ? functorBudget_ : SIZE_MAX;
+    while (runningFunctors_.size() < limit) {
+        PendingFunctor* task = pendingFunctors_.Pop();
+        if (task == nullptr) {
+            break;
+        }
+        runningFunctors_.push_back(task);
     }
-    for (const Functor& functor : functors) {
-        functor();  // 执行回调
+    functorsCarriedOver_ = runningFunctors_.size() == limit && !pendingFunctors_.Empty();
+    queuedFunctors_.fetch_sub(runningFunctors_.size(), std::memory_order_relaxed);
+    for (PendingFunctor* task : runningFunctors_) {
+        task->run();  // 执行回调
+        delete task;
     }
+    size_t count = runningFunctors_.size();
+    runningFunctors_.clear();
     callingPendingFunctors_ = false;
+    return count;
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "EventLoopMetrics.h"
+
+LogLinearHistogram::LogLinearHistogram() : sum_(0), max_(0) {
+    for (auto& c : counts_) {
+        c.store(0, std::memory_order_relaxed);
+    }
+}
+
+// 小于kSubBuckets的值线性映射；否则按最高位所在的2的幂分段，再取最高位之后的kSubBucketBits位作为段内下标
+int LogLinearHistogram::bucketOf(uint64_t value) {
+    if (value < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<int>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    if (msb >= kMaxBits) {
+        return kNumBuckets - 1;
+    }
+    int shift = msb - kSubBucketBits;
+    int sub = static_cast<int>((value >> shift) & (kSubBuckets - 1));
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LogLinearHistogram::bucketUpperBound(int bucket) {
+    if (bucket < kSubBuckets) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int shift = bucket / kSubBuckets - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket % kSubBuckets);
+    return (((static_cast<uint64_t>(kSubBuckets) | sub) + 1) << shift) - 1;
+}
+
+void LogLinearHistogram::record(uint64_t value) {
+    std::atomic<uint64_t>& bucket = counts_[bucketOf(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value > max_.load(std::memory_order_relaxed)) {
+        max_.store(value, std::memory_order_relaxed);
+    }
+}
+
+LogLinearHistogram::Snapshot LogLinearHistogram::snapshot() const {
+    Snapshot snap;
+    for (int i = 0; i < kNumBuckets; ++i) {
+        snap.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        snap.count += snap.counts[i];  // 以桶计数之和为准，保证百分位计算自洽
+    }
+    snap.sum = sum_.load(std::memory_order_relaxed);
+    snap.max = max_.load(std::memory_order_relaxed);
+    return snap;
+}
+
+uint64_t LogLinearHistogram::Snapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count));
+    if (rank >= count) {
+        rank = count - 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+        seen += counts[i];
+        if (seen > rank) {
+            uint64_t upper = bucketUpperBound(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+void EventLoopMetrics::recordIteration(uint64_t pollWaitUs, uint64_t events, uint64_t handleEventUs, uint64_t functors, uint64_t pendingFunctorsUs) {
+    add(iterations_, 1);
+    add(events_, events);
+    add(functors_, functors);
+    pollWaitUs_.record(pollWaitUs);
+    eventsPerPoll_.record(events);
+    handleEventUs_.record(handleEventUs);
+    pendingFunctorDepth_.record(functors);
+    pendingFunctorsUs_.record(pendingFunctorsUs);
+}
+
+void EventLoopMetrics::recordWakeup(uint64_t writes) {
+    add(wakeupsHandled_, 1);
+    add(wakeupsWritten_, writes);
+}
+
+EventLoopMetrics::Snapshot EventLoopMetrics::snapshot() const {
+    Snapshot snap;
+    snap.iterations = iterations_.load(std::memory_order_relaxed);
+    snap.events = events_.load(std::memory_order_relaxed);
+    snap.functors = functors_.load(std::memory_order_relaxed);
+    snap.wakeupsHandled = wakeupsHandled_.load(std::memory_order_relaxed);
+    snap.wakeupsWritten = wakeupsWritten_.load(std::memory_order_relaxed);
+    snap.pollWaitUs = pollWaitUs_.snapshot();
+    snap.handleEventUs = handleEventUs_.snapshot();
+    snap.pendingFunctorsUs = pendingFunctorsUs_.snapshot();
+    snap.eventsPerPoll = eventsPerPoll_.snapshot();
+    snap.pendingFunctorDepth = pendingFunctorDepth_.snapshot();
+    return snap;
+}
@@ -1,9 +1,13 @@
 #include "EventLoopThread.h"
 
+#include <pthread.h>
+#include <sched.h>
+
 #include "EventLoop.h"
+#include "Logger.h"
 
 EventLoopThread::EventLoopThread(const ThreadInitCallback& cb, const std::string& name) :
-    loop_(nullptr), exiting_(false), thread_([this]() { threadFunc(); }, name), mutex_(), cond_(), callback_(cb) {}
+    loop_(nullptr), thread_([this]() { threadFunc(); }, name), exiting_(false), cpu_(-1), mutex_(), cond_(), callback_(cb) {}
 
 EventLoopThread::~EventLoopThread() {
     exiting_ = true;
@@ -25,6 +29,15 @@ EventLoop* EventLoopThread::startLoop() {
 }
 
 void EventLoopThread::threadFunc() {
+    if (cpu_ >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu_, &cpuset);
+        int err = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuset), &cpuset);
+        if (err != 0) {
+            LOG_ERROR("EventLoopThread %s bind to cpu %d failed:%d\n", thread_.getName().c_str(), cpu_, err);
+        }
+    }
     EventLoop loop;  // 创建独立的对象和线程一一对应， One Loop One Thread
     if (callback_) {
         callback_(&loop);
@@ -1,8 +1,102 @@
 #include "EventLoopThreadPool.h"
 
+#include <dirent.h>
+#include <sched.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include "EventLoop.h"
 #include "EventLoopThread.h"
+#include "InetAddress.h"
 #include "Logger.h"
-EventLoopThreadPool::EventLoopThreadPool(EventLoop* baseLoop, const std::string& nameArg) : baseLoop_(baseLoop), name_(nameArg), started_(false), numThreads_(0), next_(0) {}
+
+namespace {
+// 当前进程允许运行的CPU（受taskset/cgroup限制）
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    if (::sched_getaffinity(0, sizeof(cpuset), &cpuset) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpuset)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+int readSysfsInt(const std::string& path, int defaultValue) {
+    std::ifstream in(path);
+    int value = defaultValue;
+    if (!(in >> value)) {
+        return defaultValue;
+    }
+    return value;
+}
+
+// 解析 "0-3,8,10-11" 形式的CPU列表
+std::set<int> parseCpuList(const std::string& list) {
+    std::set<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.insert(cpu);
+        }
+    }
+    return cpus;
+}
+
+// 每个物理核取一个逻辑CPU（编号最小的那个），跳过超线程兄弟
+std::vector<int> physicalCoreCpus(const std::vector<int>& allowed) {
+    std::vector<int> cpus;
+    std::set<std::pair<int, int>> seen;  // (package, core)
+    for (int cpu : allowed) {
+        std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        int package = readSysfsInt(base + "physical_package_id", 0);
+        int core = readSysfsInt(base + "core_id", cpu);
+        if (seen.insert(std::make_pair(package, core)).second) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// NUMA节点 => 节点内的CPU
+std::map<int, std::set<int>> numaNodes() {
+    std::map<int, std::set<int>> nodes;
+    DIR* dir = ::opendir("/sys/devices/system/node");
+    if (dir == nullptr) {
+        return nodes;
+    }
+    while (dirent* entry = ::readdir(dir)) {
+        int node = -1;
+        if (std::sscanf(entry->d_name, "node%d", &node) != 1) {
+            continue;
+        }
+        std::ifstream in(std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist");
+        std::string list;
+        std::getline(in, list);
+        nodes[node] = parseCpuList(list);
+    }
+    ::closedir(dir);
+    return nodes;
+}
+}  // namespace
+EventLoopThreadPool::EventLoopThreadPool(EventLoop* baseLoop, const std::string& nameArg) :
+    baseLoop_(baseLoop), name_(nameArg), started_(false), numThreads_(0), next_(0), placement_(kNoAffinity), dispatch_(kRoundRobin), randomState_(0x9E3779B97F4A7C15ULL) {}
 
 EventLoopThreadPool::~EventLoopThreadPool() {
     // 不删除循环，因为这里是栈区变量
@@ -13,24 +107,149 @@ void EventLoopThreadPool::start(const ThreadInitCallback& cb) {
     if (numThreads_ == 0 && cb) {  // 单线程
         cb(baseLoop_);
     }
+    std::vector<int> plan = planCpus(placement_, numThreads_, cpus_);
     for (int i = 0; i < numThreads_; ++i) {
         char buf[name_.size() + 32];
         snprintf(buf, sizeof buf, "%s%d", name_.c_str(), i + 1);
         EventLoopThread* t = new EventLoopThread(cb, buf);
+        t->setCpuAffinity(plan[i]);
         threads_.push_back(std::unique_ptr<EventLoopThread>(t));
         loops_.push_back(t->startLoop());
     }
 }
-// 如果工作在多线程中，baseLoop_(mainLoop)会默认以轮询的方式分配Channel给subLoop
+// 如果工作在多线程中，baseLoop_(mainLoop)按分发策略选择subLoop
 EventLoop* EventLoopThreadPool::getNextLoop() {
     // 单线程， mainReactor 存在，subReactor 不存在
-    EventLoop* loop = baseLoop_;
-    if (!loops_.empty()) {
-        loop = loops_[next_];
-        ++next_;
-        if (next_ >= loops_.size()) {
-            next_ = 0;
-        }
+    if (loops_.empty()) {
+        return baseLoop_;
+    }
+    switch (dispatch_) {
+        case kLeastConnections:
+            return leastConnections();
+        case kPowerOfTwoChoices:
+            return powerOfTwoChoices();
+        default:  // 没有对端地址时kHashByPeer退化为轮询
+            return roundRobin();
+    }
+}
+
+EventLoop* EventLoopThreadPool::getNextLoop(const InetAddress& peerAddr) {
+    if (dispatch_ != kHashByPeer || loops_.empty()) {
+        return getNextLoop();
+    }
+    // 只取IP不取端口，同一客户端的多个连接落在同一loop；乘法哈希打散相邻地址
+    uint32_t ip = ntohl(peerAddr.getSockAddr()->sin_addr.s_addr);
+    uint64_t hash = static_cast<uint64_t>(ip) * 0x9E3779B97F4A7C15ULL;
+    return loops_[(hash >> 32) % loops_.size()];
+}
+
+EventLoop* EventLoopThreadPool::roundRobin() {
+    EventLoop* loop = loops_[next_];
+    ++next_;
+    if (next_ >= loops_.size()) {
+        next_ = 0;
     }
     return loop;
 }
+
+EventLoop* EventLoopThreadPool::leastConnections() {
+    // 从轮询位置开始扫描，连接数相同的loop轮流被选中
+    size_t n = loops_.size();
+    size_t best = next_;
+    int bestCount = loops_[best]->connectionCount();
+    for (size_t i = 1; i < n && bestCount > 0; ++i) {
+        size_t index = (next_ + i) % n;
+        int count = loops_[index]->connectionCount();
+        if (count < bestCount) {
+            best = index;
+            bestCount = count;
+        }
+    }
+    next_ = static_cast<int>((best + 1) % n);
+    return loops_[best];
+}
+
+EventLoop* EventLoopThreadPool::powerOfTwoChoices() {
+    size_t n = loops_.size();
+    if (n == 1) {
+        return loops_[0];
+    }
+    // xorshift64：只在baseLoop_线程调用，无需加锁
+    randomState_ ^= randomState_ << 13;
+    randomState_ ^= randomState_ >> 7;
+    randomState_ ^= randomState_ << 17;
+    size_t first = randomState_ % n;
+    size_t second = (first + 1 + (randomState_ >> 32) % (n - 1)) % n;  // 保证与first不同
+    auto load = [](EventLoop* loop) { return static_cast<size_t>(loop->connectionCount()) + loop->loadHint(); };
+    return load(loops_[second]) < load(loops_[first]) ? loops_[second] : loops_[first];
+}
+
+std::vector<EventLoop*> EventLoopThreadPool::getAllLoops() {
+    if (loops_.empty()) {
+        return std::vector<EventLoop*>(1, baseLoop_);
+    }
+    return loops_;
+}
+
+std::vector<EventLoopMetrics::Snapshot> EventLoopThreadPool::metricsSnapshots() {
+    std::vector<EventLoopMetrics::Snapshot> snapshots;
+    for (EventLoop* loop : getAllLoops()) {
+        snapshots.push_back(loop->metricsSnapshot());
+    }
+    return snapshots;
+}
+
+std::vector<int> EventLoopThreadPool::planCpus(PlacementPolicy policy, int n, const std::vector<int>& cpus) {
+    std::vector<int> plan(n, -1);
+    std::vector<int> candidates;
+    switch (policy) {
+    case kNoAffinity:
+        return plan;
+    case kExplicitCpus:
+        candidates = cpus;
+        break;
+    case kOnePerPhysicalCore:
+        candidates = physicalCoreCpus(allowedCpus());
+        break;
+    case kSpreadNumaNodes: {
+        // 各节点按物理核分组后交错排列：node0的第1个核、node1的第1个核、node0的第2个核……
+        std::vector<int> cores = physicalCoreCpus(allowedCpus());
+        std::vector<std::vector<int>> perNode;
+        for (const auto& node : numaNodes()) {
+            std::vector<int> nodeCpus;
+            for (int cpu : cores) {
+                if (node.second.count(cpu)) {
+                    nodeCpus.push_back(cpu);
+                }
+            }
+            if (!nodeCpus.empty()) {
+                perNode.push_back(nodeCpus);
+            }
+        }
+        if (perNode.empty()) {  // 没有NUMA信息时退化为按物理核分配
+            candidates = cores;
+            break;
+        }
+        size_t total = 0;
+        for (const auto& nodeCpus : perNode) {
+            total += nodeCpus.size();
+        }
+        for (size_t round = 0; candidates.size() < total; ++round) {
+            for (const auto& nodeCpus : perNode) {
+                if (round < nodeCpus.size()) {
+                    candidates.push_back(nodeCpus[round]);
+                }
+            }
+        }
+        break;
+    }
+    }
+    if (candidates.empty()) {
+        LOG_WARN("EventLoopThreadPool placement policy %d has no usable cpu, threads are not pinned\n", policy);
+        return plan;
+    }
+    for (int i = 0; i < n; ++i) {
+        plan[i] = candidates[i % candidates.size()];
+    }
+    return plan;
+}
@@ -0,0 +1,230 @@
+#include "HotRestart.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+
+#include "EventLoop.h"
+#include "Logger.h"
+#include "TcpServer.h"
+
+namespace {
+// 控制通道上的消息：4字节类型 + 数据，fd通过SCM_RIGHTS随消息携带；SEQPACKET保证消息边界
+enum MessageType : uint32_t {
+    kListenFd = 1,  // 监听socket
+    kConnection = 2,  // 一个已建立的连接，数据为其未处理的输入
+    kDone = 3,  // 交接完成
+};
+
+const size_t kMaxMessage = sizeof(uint32_t) + HotRestart::kMaxPendingInput;
+
+bool sendMessage(int sock, uint32_t type, int fd, const std::string& data) {
+    iovec vec[2];
+    vec[0].iov_base = &type;
+    vec[0].iov_len = sizeof(type);
+    vec[1].iov_base = const_cast<char*>(data.data());
+    vec[1].iov_len = data.size();
+
+    msghdr msg;
+    ::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vec;
+    msg.msg_iovlen = data.empty() ? 1 : 2;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (fd >= 0) {
+        ::memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        ::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    ssize_t n;
+    do {
+        n = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        LOG_ERROR("HotRestart sendmsg type:%u err:%d\n", type, errno);
+        return false;
+    }
+    return true;
+}
+
+// 返回false表示连接断开或出错
+bool recvMessage(int sock, uint32_t* type, int* fd, std::string* data) {
+    std::string buf(kMaxMessage, '\0');
+    iovec vec;
+    vec.iov_base = &buf[0];
+    vec.iov_len = buf.size();
+    msghdr msg;
+    ::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    *fd = -1;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            ::memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    if (n < static_cast<ssize_t>(sizeof(uint32_t)) || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+        if (*fd >= 0) {
+            ::close(*fd);
+        }
+        if (n < 0) {
+            LOG_ERROR("HotRestart recvmsg err:%d\n", errno);
+        }
+        return false;
+    }
+    ::memcpy(type, buf.data(), sizeof(uint32_t));
+    data->assign(buf.data() + sizeof(uint32_t), n - sizeof(uint32_t));
+    return true;
+}
+
+sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un addr;
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    ::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+}  // namespace
+
+HotRestart::HotRestart(EventLoop* loop, TcpServer* server, const std::string& path) :
+    loop_(loop),
+    server_(server),
+    path_(path),
+    listenFd_(::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)),
+    listenChannel_(loop, listenFd_),
+    handOffConnections_(true) {
+    if (listenFd_ < 0) {
+        LOG_FATAL("HotRestart socket err:%d\n", errno);
+    }
+    listenChannel_.setReadCallback([this](TimeStamp) { this->handleRead(); });
+}
+
+HotRestart::~HotRestart() {
+    listenChannel_.disableAll();
+    listenChannel_.remove();
+    ::close(listenFd_);
+    ::unlink(path_.c_str());
+}
+
+void HotRestart::listen() {
+    sockaddr_un addr = unixAddress(path_);
+    ::unlink(path_.c_str());  // 上一次运行残留的socket文件
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listenFd_, 1) < 0) {
+        LOG_ERROR("HotRestart listen on %s err:%d\n", path_.c_str(), errno);
+        return;
+    }
+    listenChannel_.enableReading();
+}
+
+void HotRestart::handleRead() {
+    int controlFd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);  // 阻塞fd：交接期间按消息顺序同步发送
+    if (controlFd < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_ERROR("HotRestart accept err:%d\n", errno);
+        }
+        return;
+    }
+    if (server_->listenFd() < 0) {  // 已经交接过，或处于每loop Acceptor模式
+        LOG_ERROR("HotRestart: no listening socket to hand off\n");
+        ::close(controlFd);
+        return;
+    }
+    listenChannel_.disableAll();  // 只交接一次
+    handOff(controlFd);
+}
+
+void HotRestart::handOff(int controlFd) {
+    LOG_INFO("HotRestart: handing off %s\n", path_.c_str());
+    if (!sendMessage(controlFd, kListenFd, server_->listenFd(), std::string())) {
+        ::close(controlFd);
+        listenChannel_.enableReading();  // 继续服务，等待下一次升级请求
+        return;
+    }
+    // 监听fd已在途（内核持有引用），关闭本端副本；backlog中的连接由新进程accept
+    server_->stopListening();
+
+    // 各连接在自己的loop中交出，最后一个完成后发送kDone并回到mainLoop通知上层
+    struct Progress {
+        int controlFd;
+        std::atomic<size_t> remaining;
+    };
+    std::vector<TcpConnectionPtr> conns;
+    if (handOffConnections_) {
+        conns = server_->connectionList();
+    }
+    auto progress = std::make_shared<Progress>();
+    progress->controlFd = controlFd;
+    progress->remaining = conns.size() + 1;
+    EventLoop* mainLoop = loop_;
+    HandOffCompleteCallback complete = handOffCompleteCallback_;
+    auto finish = [progress, mainLoop, complete]() {
+        if (progress->remaining.fetch_sub(1) != 1) {
+            return;
+        }
+        sendMessage(progress->controlFd, kDone, -1, std::string());
+        ::close(progress->controlFd);
+        if (complete) {
+            mainLoop->runInLoop(complete);
+        }
+    };
+    for (const TcpConnectionPtr& conn : conns) {
+        conn->getLoop()->runInLoop([conn, progress, finish]() {
+            conn->handOffInLoop([progress](int sockfd, const std::string& pendingInput) {
+                return pendingInput.size() <= kMaxPendingInput && sendMessage(progress->controlFd, kConnection, sockfd, pendingInput);
+            });
+            finish();
+        });
+    }
+    finish();
+}
+
+bool HotRestart::takeOver(const std::string& path, TakeOverState* state) {
+    int sock = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return false;
+    }
+    sockaddr_un addr = unixAddress(path);
+    if (::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(sock);
+        return false;  // 没有旧进程在运行
+    }
+    bool done = false;
+    uint32_t type = 0;
+    int fd = -1;
+    std::string data;
+    while (recvMessage(sock, &type, &fd, &data)) {
+        if (type == kListenFd && fd >= 0) {
+            state->listenFd = fd;
+        } else if (type == kConnection && fd >= 0) {
+            state->connections.push_back(InheritedConnection{fd, data});
+        } else if (type == kDone) {
+            done = true;
+            break;
+        } else if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    ::close(sock);
+    // 旧进程中途退出时，已收到的监听socket和连接仍然有效
+    if (!done) {
+        LOG_ERROR("HotRestart: hand off from %s ended early\n", path.c_str());
+    }
+    return state->listenFd >= 0;
+}
@@ -0,0 +1,284 @@
+#include "IoUringPoller.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "Channel.h"
+#include "Logger.h"
+
+namespace {
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringfd, unsigned toSubmit, unsigned minComplete, unsigned flags, const void* arg, size_t argSize) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringfd, toSubmit, minComplete, flags, arg, argSize));
+}
+
+// 本实现依赖的内核特性：EXT_ARG（带超时的等待）与 NODROP（CQ溢出时不丢事件）
+const unsigned kRequiredFeatures = IORING_FEAT_EXT_ARG | IORING_FEAT_NODROP;
+}  // namespace
+
+bool IoUringPoller::isSupported() {
+    io_uring_params params;
+    ::memset(&params, 0, sizeof(params));
+    int fd = ioUringSetup(4, &params);
+    if (fd < 0) {
+        return false;
+    }
+    ::close(fd);
+    return (params.features & kRequiredFeatures) == kRequiredFeatures;
+}
+
+IoUringPoller::IoUringPoller(EventLoop* loop) :
+    Poller(loop),
+    ringfd_(-1),
+    sqRingPtr_(MAP_FAILED),
+    sqRingSize_(0),
+    sqes_(static_cast<io_uring_sqe*>(MAP_FAILED)),
+    sqesSize_(0),
+    sqeTail_(0),
+    sqeHead_(0),
+    cqRingPtr_(MAP_FAILED),
+    cqRingSize_(0),
+    nextSeq_(0) {
+    io_uring_params params;
+    ::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = kCqEntries;
+    ringfd_ = ioUringSetup(kRingEntries, &params);
+    if (ringfd_ < 0) {
+        LOG_FATAL("io_uring_setup error:%d \n", errno);
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {  // SQ环与CQ环共用一次映射
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+    sqRingPtr_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQ_RING);
+    if (sqRingPtr_ == MAP_FAILED) {
+        LOG_FATAL("io_uring mmap sq ring error:%d \n", errno);
+    }
+    if (singleMmap) {
+        cqRingPtr_ = sqRingPtr_;
+    } else {
+        cqRingPtr_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_CQ_RING);
+        if (cqRingPtr_ == MAP_FAILED) {
+            LOG_FATAL("io_uring mmap cq ring error:%d \n", errno);
+        }
+    }
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+        LOG_FATAL("io_uring mmap sqes error:%d \n", errno);
+    }
+
+    char* sq = static_cast<char*>(sqRingPtr_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqRingMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqeTail_ = sqeHead_ = *sqTail_;
+
+    char* cq = static_cast<char*>(cqRingPtr_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqRingMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+IoUringPoller::~IoUringPoller() {
+    if (sqes_ != MAP_FAILED) {
+        ::munmap(sqes_, sqesSize_);
+    }
+    if (cqRingPtr_ != MAP_FAILED && cqRingPtr_ != sqRingPtr_) {
+        ::munmap(cqRingPtr_, cqRingSize_);
+    }
+    if (sqRingPtr_ != MAP_FAILED) {
+        ::munmap(sqRingPtr_, sqRingSize_);
+    }
+    ::close(ringfd_);
+}
+
+TimeStamp IoUringPoller::poll(int timeoutMs, ChannelList* activeChannels) {
+    rearmFired();
+    unsigned toSubmit = flushSq();
+    // CQ中已有未收割的事件时不再阻塞等待
+    unsigned ready = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE) - *cqHead_;
+    int ret = enter(toSubmit, ready > 0 ? 0 : 1, IORING_ENTER_GETEVENTS, timeoutMs);
+    int saveErrno = errno;
+    TimeStamp now(TimeStamp::now());
+
+    int numEvents = reapCompletions(activeChannels);
+    if (numEvents > 0) {
+        LOG_DEBUG("%d events happend\n", numEvents);
+    } else if (ret >= 0 || saveErrno == ETIME) {
+        LOG_DEBUG("%s timeout \n", __FUNCTION__);
+    } else if (saveErrno != EINTR && saveErrno != EBUSY) {
+        errno = saveErrno;
+        LOG_ERROR("IoUringPoller::poll() error:%d \n", saveErrno);
+    }
+    return now;
+}
+
+// 与EPollPoller保持一致的状态机：kNew/kDeleted => ADD；kAdded => MOD或DEL
+// 区别在于这里只是写入SQE，真正的提交推迟到下一次poll
+void IoUringPoller::updateChannel(Channel* channel) {
+    const int fd = channel->getFd();
+    ChannelEntry& entry = entryOf(fd);
+    if (entry.channel != channel) {  // 新的Channel（或fd被复用），之前的请求作废
+        cancelPoll(stateOf(fd));
+        entry.channel = channel;
+        entry.state = kNew;
+    }
+    if (entry.state == kNew || entry.state == kDeleted) {
+        entry.state = kAdded;
+        armPoll(fd, channel);
+    } else {
+        cancelPoll(stateOf(fd));
+        if (channel->isNoneEvent()) {
+            entry.state = kDeleted;
+        } else {
+            armPoll(fd, channel);
+        }
+    }
+}
+
+void IoUringPoller::removeChannel(Channel* channel) {
+    const int fd = channel->getFd();
+    ChannelEntry& entry = entryOf(fd);
+    if (entry.channel != channel) {
+        return;  // 不属于当前Poller管理的Channel
+    }
+    cancelPoll(stateOf(fd));
+    entry = ChannelEntry();
+}
+
+IoUringPoller::PollState& IoUringPoller::stateOf(int fd) {
+    if (static_cast<size_t>(fd) >= states_.size()) {
+        states_.resize(std::max<size_t>(fd + 1, states_.size() * 2));
+    }
+    return states_[fd];
+}
+
+io_uring_sqe* IoUringPoller::getSqe() {
+    const unsigned entries = sqRingMask_ + 1;
+    while (sqeTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= entries) {
+        // SQ已满：先把已有请求提交给内核，腾出空间
+        if (enter(flushSq(), 0, 0, -1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            LOG_FATAL("io_uring_enter submit error:%d \n", errno);
+        }
+    }
+    io_uring_sqe* sqe = &sqes_[sqeTail_ & sqRingMask_];
+    ++sqeTail_;
+    ::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+unsigned IoUringPoller::flushSq() {
+    unsigned tail = *sqTail_;
+    while (sqeHead_ != sqeTail_) {
+        sqArray_[tail & sqRingMask_] = sqeHead_ & sqRingMask_;
+        ++tail;
+        ++sqeHead_;
+    }
+    __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+    return tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+}
+
+int IoUringPoller::enter(unsigned toSubmit, unsigned minComplete, unsigned flags, int timeoutMs) {
+    if (minComplete == 0 || timeoutMs < 0) {
+        return ioUringEnter(ringfd_, toSubmit, minComplete, flags, nullptr, _NSIG / 8);
+    }
+    __kernel_timespec ts;
+    ts.tv_sec = timeoutMs / 1000;
+    ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000 * 1000;
+    io_uring_getevents_arg arg;
+    ::memset(&arg, 0, sizeof(arg));
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+    return ioUringEnter(ringfd_, toSubmit, minComplete, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+void IoUringPoller::armPoll(int fd, Channel* channel) {
+    if (++nextSeq_ == 0) {  // 序号回绕时跳过0，保证token不等于kIgnoredToken
+        ++nextSeq_;
+    }
+    PollState& state = stateOf(fd);
+    state.token = (static_cast<uint64_t>(static_cast<uint32_t>(fd)) << 32) | nextSeq_;
+    state.armed = true;
+
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = static_cast<uint32_t>(channel->getEvents()) & 0xffff;  // 只保留poll可识别的事件位
+    if (channel->isEdgeTriggered()) {
+        sqe->len = IORING_POLL_ADD_MULTI;  // 边沿触发的Channel使用multishot poll，触发后无需重新注册
+    }
+    sqe->user_data = state.token;
+}
+
+void IoUringPoller::cancelPoll(PollState& state) {
+    if (state.armed) {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_POLL_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = state.token;
+        sqe->user_data = kIgnoredToken;
+    }
+    state.armed = false;
+    state.token = kIgnoredToken;  // 旧请求之后的完成事件都会因token不匹配被丢弃
+}
+
+void IoUringPoller::rearmFired() {
+    for (int fd : rearmFds_) {
+        const ChannelEntry& entry = channels_[fd];
+        // 已被移除，或回调中已调用过updateChannel重新注册/禁用的fd无需处理
+        if (entry.channel != nullptr && entry.state == kAdded && !states_[fd].armed && !entry.channel->isNoneEvent()) {
+            armPoll(fd, entry.channel);
+        }
+    }
+    rearmFds_.clear();
+}
+
+int IoUringPoller::reapCompletions(ChannelList* activeChannels) {
+    int numEvents = 0;
+    unsigned head = *cqHead_;
+    const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & cqRingMask_];
+        const uint64_t token = cqe.user_data;
+        if (token == kIgnoredToken) {
+            continue;
+        }
+        const int fd = static_cast<int>(token >> 32);
+        if (static_cast<size_t>(fd) >= states_.size() || states_[fd].token != token) {
+            continue;  // 已取消或已被替换的旧请求
+        }
+        PollState& state = states_[fd];
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            state.armed = false;  // 单次请求已结束
+        }
+        if (!state.armed) {
+            rearmFds_.push_back(fd);  // 出错结束的请求同样要重新注册，否则该Channel再也收不到事件
+        }
+        if (cqe.res < 0) {
+            LOG_ERROR("io_uring poll fd = %d error:%d \n", fd, -cqe.res);
+            continue;
+        }
+        Channel* channel = channels_[fd].channel;
+        channel->setRevents(cqe.res);  // poll返回的事件位与EPOLLIN/EPOLLOUT等取值一致
+        activeChannels->push_back(channel);
+        ++numEvents;
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    return numEvents;
+}
@@ -2,12 +2,13 @@
 
 #include "Channel.h"
 #include "EPollPoller.h"
+#include "IoUringPoller.h"
+#include "Logger.h"
 
 Poller::Poller(EventLoop* loop) : ownerLoop_(loop) {}
 
 bool Poller::hasChannel(Channel* channel) const {
-    auto it = channels_.find(channel->getFd());
-    return it != channels_.end() && it->second == channel;
+    return findChannel(channel->getFd()) == channel;
 }
 
 // 静态方法
@@ -15,7 +16,13 @@ Poller* Poller::newDefaultPoller(EventLoop* loop) {
     // 通过环境变量决定使用 poll 还是 epoll
     if (::getenv("MUDUO_USE_POLL")) {
         return nullptr;  // 此处未实现对于poll接口的支持
-    } else {
-        return new EPollPoller(loop);
     }
+    // 通过环境变量 MUDUO_USE_IO_URING 选择io_uring，内核不支持时回退到epoll
+    if (::getenv("MUDUO_USE_IO_URING")) {
+        if (IoUringPoller::isSupported()) {
+            return new IoUringPoller(loop);
+        }
+        LOG_WARN("io_uring is not supported by the kernel, fall back to epoll\n");
+    }
+    return new EPollPoller(loop);
 }
\ No newline at end of file
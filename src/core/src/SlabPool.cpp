@@ -0,0 +1,67 @@
+#include "SlabPool.h"
+
+#include "CurrentThread.h"
+
+SlabPool::SlabPool(size_t maxCachedBytes) : ownerTid_(CurrentThread::tid()), maxCachedBytes_(maxCachedBytes), bytesInUse_(0), bytesCached_(0), heapAllocations_(0) {}
+
+SlabPool::~SlabPool() {
+    for (const auto& freeList : freeLists_) {
+        for (char* data : freeList) {
+            delete[] data;
+        }
+    }
+}
+
+int SlabPool::classOf(size_t size) {
+    if (size > kMaxClassSize) {
+        return -1;
+    }
+    int cls = 0;
+    size_t classSize = kMinClassSize;
+    while (classSize < size) {
+        classSize <<= 1;
+        ++cls;
+    }
+    return cls;
+}
+
+size_t SlabPool::roundUp(size_t size) {
+    int cls = classOf(size);
+    return cls < 0 ? size : kMinClassSize << cls;
+}
+
+char* SlabPool::allocate(size_t size) {
+    size_t actual = roundUp(size);
+    bytesInUse_.fetch_add(actual, std::memory_order_relaxed);
+    int cls = classOf(size);
+    if (cls >= 0 && !freeLists_[cls].empty()) {
+        char* data = freeLists_[cls].back();
+        freeLists_[cls].pop_back();
+        bytesCached_.fetch_sub(actual, std::memory_order_relaxed);
+        return data;
+    }
+    heapAllocations_.fetch_add(1, std::memory_order_relaxed);
+    return new char[actual];  // 不做值初始化
+}
+
+void SlabPool::release(char* data, size_t size) {
+    size_t actual = roundUp(size);
+    bytesInUse_.fetch_sub(actual, std::memory_order_relaxed);
+    int cls = classOf(size);
+    if (cls >= 0 && bytesCached() + actual <= maxCachedBytes_) {
+        freeLists_[cls].push_back(data);
+        bytesCached_.fetch_add(actual, std::memory_order_relaxed);
+    } else {
+        delete[] data;
+    }
+}
+
+void SlabPool::deallocate(char* data, size_t size) {
+    if (CurrentThread::tid() == ownerTid_) {
+        release(data, size);
+        return;
+    }
+    // 空闲链表只能在所属线程访问；统计是原子的，照常扣减
+    bytesInUse_.fetch_sub(roundUp(size), std::memory_order_relaxed);
+    delete[] data;
+}
@@ -1,5 +1,7 @@
 #include "Socket.h"
 
+#include <errno.h>
+#include <linux/filter.h>
 #include <netinet/tcp.h>
 #include <string.h>
 #include <sys/socket.h>
@@ -61,6 +63,27 @@ void Socket::setReusePort(bool on) {
     ::setsockopt(sockfd_, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval));
 }
 
+// 为SO_REUSEPORT组挂载cBPF程序：返回 当前CPU % groupSize 作为组内socket下标（按listen顺序编号）。
+// 配合第i个loop绑定到CPU i，连接由处理其软中断的CPU上的loop接收。对组内任一socket设置即对整组生效。
+bool Socket::setReusePortCpuSteering(int groupSize) {
+    if (groupSize <= 0) {
+        return false;
+    }
+    sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},  // A = 当前CPU
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(groupSize)},  // A %= groupSize
+        {BPF_RET | BPF_A, 0, 0, 0},  // return A
+    };
+    sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    if (::setsockopt(sockfd_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0) {
+        LOG_ERROR("sockfd:%d attach reuseport cbpf err:%d\n", sockfd_, errno);
+        return false;
+    }
+    return true;
+}
+
 // SO_KEEPALIVE 启用在已连接的套接字上定期传输消息。
 // 如果另一端没有响应，则认为连接已断开并关闭。
 // 这对于检测网络中失效的对等方非常有用。
@@ -68,3 +91,47 @@ void Socket::setKeepAlive(bool on) {
     int optval = on ? 1 : 0;
     ::setsockopt(sockfd_, SOL_SOCKET, SO_KEEPALIVE, &optval, sizeof(optval));
 }
+// SO_ZEROCOPY 允许send时带MSG_ZEROCOPY：内核直接引用用户页面而不复制，完成通知从错误队列读取（Linux 4.14+）。
+bool Socket::setZeroCopy(bool on) {
+    int optval = on ? 1 : 0;
+    if (::setsockopt(sockfd_, SOL_SOCKET, SO_ZEROCOPY, &optval, sizeof(optval)) < 0) {
+        LOG_WARN("setsockopt SO_ZEROCOPY fd:%d failed: %s", sockfd_, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+InetAddress Socket::getLocalAddr(int sockfd) {
+    sockaddr_in local;
+    socklen_t addrLen = sizeof(local);
+    ::memset(&local, 0, addrLen);
+    if (::getsockname(sockfd, (sockaddr*) &local, &addrLen) < 0) {
+        LOG_ERROR("socket::getLocalAddr");
+    }
+    return InetAddress(local);
+}
+
+InetAddress Socket::getPeerAddr(int sockfd) {
+    sockaddr_in peer;
+    socklen_t addrLen = sizeof(peer);
+    ::memset(&peer, 0, addrLen);
+    if (::getpeername(sockfd, (sockaddr*) &peer, &addrLen) < 0) {
+        LOG_ERROR("socket::getPeerAddr");
+    }
+    return InetAddress(peer);
+}
+
+int Socket::getSocketError(int sockfd) {
+    int optval = 0;
+    socklen_t optlen = sizeof(optval);
+    if (::getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &optval, &optlen) < 0) {
+        return errno;
+    }
+    return optval;
+}
+
+bool Socket::isSelfConnect(int sockfd) {
+    InetAddress local = getLocalAddr(sockfd);
+    InetAddress peer = getPeerAddr(sockfd);
+    return local.getSockAddr()->sin_port == peer.getSockAddr()->sin_port && local.getSockAddr()->sin_addr.s_addr == peer.getSockAddr()->sin_addr.s_addr;
+}
@@ -0,0 +1,101 @@
+#include "TcpClient.h"
+
+#include <stdio.h>
+
+#include "EventLoop.h"
+#include "Logger.h"
+#include "Socket.h"
+
+namespace {
+EventLoop* CheckLoopNotNull(EventLoop* loop) {
+    if (loop == nullptr) {
+        LOG_FATAL("%s:%s:%d client loop is null!\n", __FILE__, __FUNCTION__, __LINE__);
+    }
+    return loop;
+}
+}  // namespace
+
+TcpClient::TcpClient(EventLoop* loop, const InetAddress& serverAddr, const std::string& nameArg) :
+    loop_(CheckLoopNotNull(loop)),
+    connector_(new Connector(loop, serverAddr)),
+    name_(nameArg),
+    retry_(false),
+    connect_(false),
+    nextConnId_(1)
+{
+    connector_->setNewConnectionCallback([this](int sockfd) { this->newConnection(sockfd); });
+    LOG_INFO("TcpClient::TcpClient [%s] - connector to %s\n", name_.c_str(), serverAddr.toIpPort().c_str());
+}
+
+TcpClient::~TcpClient() {
+    LOG_INFO("TcpClient::~TcpClient [%s]\n", name_.c_str());
+    TcpConnectionPtr conn;
+    bool unique = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unique = connection_.use_count() == 1;
+        conn = connection_;
+    }
+    if (conn) {
+        // TcpClient析构后连接可能还活着（用户仍持有），关闭回调不能再指向this
+        loop_->runInLoop([conn]() {
+            conn->setCloseCallback([](const TcpConnectionPtr& c) { c->getLoop()->queueInLoop([c]() { c->connectDestroyed(); }); });
+        });
+        if (unique) {
+            conn->forceClose();
+        }
+    } else {
+        connector_->stop();  // stopInLoop持有connector_的引用，连接中的channel会在loop线程中释放
+    }
+}
+
+void TcpClient::connect() {
+    LOG_INFO("TcpClient::connect [%s] - connecting to %s\n", name_.c_str(), connector_->serverAddress().toIpPort().c_str());
+    connect_ = true;
+    connector_->start();
+}
+
+void TcpClient::disconnect() {
+    connect_ = false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connection_) {
+        connection_->shutdown();
+    }
+}
+
+void TcpClient::stop() {
+    connect_ = false;
+    connector_->stop();
+}
+
+void TcpClient::newConnection(int sockfd) {
+    InetAddress peerAddr(Socket::getPeerAddr(sockfd));
+    char buf[64] = {0};
+    snprintf(buf, sizeof buf, ":%s#%d", peerAddr.toIpPort().c_str(), nextConnId_);
+    ++nextConnId_;
+    std::string connName = name_ + buf;
+
+    InetAddress localAddr(Socket::getLocalAddr(sockfd));
+    TcpConnectionPtr conn(new TcpConnection(loop_, connName, sockfd, localAddr, peerAddr));
+    conn->setConnectionCallback(connectionCallback_);
+    conn->setMessageCallback(messageCallback_);
+    conn->setWriteCompleteCallback(writeCompleteCallback_);
+    conn->setCloseCallback([this](const TcpConnectionPtr& c) { this->removeConnection(c); });
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection_ = conn;
+    }
+    conn->connectEstablished();
+}
+
+void TcpClient::removeConnection(const TcpConnectionPtr& conn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection_.reset();
+    }
+    loop_->queueInLoop([conn]() { conn->connectDestroyed(); });
+    if (retry_ && connect_) {
+        LOG_INFO("TcpClient::removeConnection [%s] - reconnecting to %s\n", name_.c_str(), connector_->serverAddress().toIpPort().c_str());
+        connector_->restart();
+    }
+}
@@ -1,6 +1,16 @@
 #include "TcpConnection.h"
 
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
 #include <sys/sendfile.h> // for sendfile
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 
 #include "Channel.h"
 #include "EventLoop.h"
@@ -18,11 +28,25 @@ TcpConnection::TcpConnection(EventLoop* loop, const std::string& nameArg, int so
     name_(nameArg),
     state_(kConnecting),
     reading_(true),
+    readPaused_(false),
+    backpressure_(false),
+    edgeTriggered_(false),
+    eventByteBudget_(kDefaultEventByteBudget),
     socket_(new Socket(sockfd)),
     channel_(new Channel(loop, sockfd)),
     localAddr_(localAddr),
     peerAddr_(peerAddr),
-    highWaterMark_(64 * 1024 * 1024)  // 64M
+    inputBuffer_(&loop->slabPool()),
+    outputBuffer_(&loop->slabPool()),
+    inputShrinkScheduled_(false),
+    zeroCopyThreshold_(0),
+    zeroCopySocket_(false),
+    zeroCopyNextId_(0),
+    readIdleTimeout_(0),
+    writeIdleTimeout_(0),
+    lifetimeLimit_(0),
+    highWaterMark_(64 * 1024 * 1024),  // 64M
+    lowWaterMark_(0)
 {
     channel_->setReadCallback([this](TimeStamp t) { this->handleRead(t); });
     channel_->setWriteCallback([this]() { this->handleWrite(); });
@@ -50,6 +74,61 @@ void TcpConnection::send(const std::string& buf) {
     }
 }
 
+void TcpConnection::send(std::string&& buf) {
+    if (state_ == kConnected) {
+        if (loop_->isInLoopThread()) {
+            sendInLoop(buf.data(), buf.size());
+        } else {
+            loop_->runInLoop([self = shared_from_this(), buf = std::move(buf)]() {
+                if (self->state_ == kConnected) {
+                    self->sendInLoop(buf.data(), buf.size());
+                }
+            });
+        }
+    }
+}
+
+void TcpConnection::send(const char* data, size_t len) {
+    if (state_ == kConnected) {
+        if (loop_->isInLoopThread()) {
+            sendInLoop(data, len);
+        } else {
+            send(std::string(data, len));  // 调用方的内存可能在返回后失效，只能复制一次
+        }
+    }
+}
+
+void TcpConnection::send(Buffer* buf) {
+    if (state_ == kConnected) {
+        if (loop_->isInLoopThread()) {
+            sendInLoop(buf->peek(), buf->readableBytes());
+            buf->retrieveAll();
+        } else if (buf->pooled()) {
+            send(buf->retrieveAllAsString());  // 池存储属于调用方的loop，不能交给其他线程
+        } else {
+            loop_->runInLoop([self = shared_from_this(), owned = std::move(*buf)]() {
+                if (self->state_ == kConnected) {
+                    self->sendInLoop(owned.peek(), owned.readableBytes());
+                }
+            });
+        }
+    }
+}
+
+void TcpConnection::send(const SharedSlice& slice) {
+    if (state_ == kConnected) {
+        if (loop_->isInLoopThread()) {
+            sendInLoop(slice.data(), slice.size(), &slice);
+        } else {
+            loop_->runInLoop([self = shared_from_this(), slice]() {  // 只拷贝引用
+                if (self->state_ == kConnected) {
+                    self->sendInLoop(slice.data(), slice.size(), &slice);
+                }
+            });
+        }
+    }
+}
+
 void TcpConnection::sendFile(int fileDescriptor, off_t offset, size_t count) {
     if (connected()) {
         if (loop_->isInLoopThread()) {  // 是否位于当前循环
@@ -62,6 +141,54 @@ void TcpConnection::sendFile(int fileDescriptor, off_t offset, size_t count) {
     }
 }
 
+void TcpConnection::startRead() {
+    loop_->runInLoop([self = shared_from_this()]() { self->startReadInLoop(); });
+}
+
+void TcpConnection::stopRead() {
+    loop_->runInLoop([self = shared_from_this()]() { self->stopReadInLoop(); });
+}
+
+void TcpConnection::startReadInLoop() {
+    reading_ = true;
+    updateReading();
+}
+
+void TcpConnection::stopReadInLoop() {
+    reading_ = false;
+    updateReading();
+}
+
+void TcpConnection::setReadBackpressure(size_t highWaterMark, size_t lowWaterMark) {
+    backpressure_ = highWaterMark > 0;
+    if (backpressure_) {
+        highWaterMark_ = highWaterMark;
+        lowWaterMark_ = lowWaterMark < highWaterMark ? lowWaterMark : highWaterMark / 2;
+    }
+    checkBackpressure();
+}
+
+void TcpConnection::updateReading() {
+    if (state_ != kConnected && state_ != kDisconnecting) {
+        return;  // 尚未建立时由connectEstablished按状态注册；已断开的连接不再注册
+    }
+    bool wantRead = reading_ && !readPaused_;
+    if (wantRead && !channel_->isReading()) {
+        channel_->enableReading();  // ET模式下Poller对改变过读兴趣的fd总会重新MOD，暂停期间已到达的数据会再报告一次
+    } else if (!wantRead && channel_->isReading()) {
+        channel_->disableReading();
+    }
+}
+
+void TcpConnection::checkBackpressure() {
+    size_t pending = outputBuffer_.readableBytes();
+    bool pause = backpressure_ && (readPaused_ ? pending > lowWaterMark_ : pending >= highWaterMark_);
+    if (pause != readPaused_) {
+        readPaused_ = pause;
+        updateReading();
+    }
+}
+
 void TcpConnection::shutdown() {
     if (state_ == kConnected) {
         setState(kDisconnecting);
@@ -69,10 +196,107 @@ void TcpConnection::shutdown() {
     }
 }
 
+void TcpConnection::forceClose() {
+    if (state_ == kConnected || state_ == kDisconnecting) {
+        setState(kDisconnecting);
+        loop_->queueInLoop([self = shared_from_this()]() { self->forceCloseInLoop(); });
+    }
+}
+
+void TcpConnection::forceCloseInLoop() {
+    if (state_ == kConnected || state_ == kDisconnecting) {
+        handleClose();  // 与对端关闭的处理一致，析构时关闭fd
+    }
+}
+
+void TcpConnection::setZeroCopyThreshold(size_t bytes) {
+    if (bytes > 0 && !zeroCopySocket_) {
+        if (!socket_->setZeroCopy(true)) {
+            return;
+        }
+        zeroCopySocket_ = true;
+    }
+    zeroCopyThreshold_ = bytes;
+}
+
+void TcpConnection::setIdleTimeouts(double readIdle, double writeIdle, double lifetime) {
+    readIdleTimeout_ = readIdle;
+    writeIdleTimeout_ = writeIdle;
+    lifetimeLimit_ = lifetime;
+}
+
+TimingWheel::EntryPtr TcpConnection::armIdleTimer(double timeout, const char* reason) {
+    if (timeout <= 0) {
+        return nullptr;
+    }
+    std::weak_ptr<TcpConnection> weakSelf = shared_from_this();
+    return loop_->timingWheel().add(timeout, [weakSelf, reason]() {
+        if (TcpConnectionPtr self = weakSelf.lock()) {
+            LOG_INFO("TcpConnection %s closed: %s timeout", self->name_.c_str(), reason);
+            self->forceClose();
+        }
+    });
+}
+
+void TcpConnection::startIdleTimers() {
+    readIdleEntry_ = armIdleTimer(readIdleTimeout_, "read idle");
+    writeIdleEntry_ = armIdleTimer(writeIdleTimeout_, "write idle");
+    lifetimeEntry_ = armIdleTimer(lifetimeLimit_, "lifetime");
+}
+
+void TcpConnection::cancelIdleTimers() {
+    for (TimingWheel::EntryPtr* entry : {&readIdleEntry_, &writeIdleEntry_, &lifetimeEntry_}) {
+        if (*entry) {
+            (*entry)->cancel();
+            entry->reset();
+        }
+    }
+}
+
+void TcpConnection::setEdgeTriggered(bool on) {
+    edgeTriggered_ = on;
+    channel_->setEdgeTriggered(on);
+}
+
+bool TcpConnection::handOffInLoop(const HandOffFunction& transfer) {
+    if (state_ != kConnected || isSending()) {  // 正在发送的连接留在本进程排空
+        return false;
+    }
+    // 经reading_停止读，isReading()如实反映；之后到达的数据留在内核中，随fd一起交接
+    bool wasReading = reading_;
+    reading_ = false;
+    updateReading();
+    std::string pendingInput(inputBuffer_.peek(), inputBuffer_.readableBytes());
+    if (!transfer(channel_->getFd(), pendingInput)) {
+        reading_ = wasReading;
+        updateReading();
+        return false;
+    }
+    inputBuffer_.retrieveAll();
+    handleClose();
+    return true;
+}
+
+void TcpConnection::restoreInput(const std::string& pendingInput) {
+    if (pendingInput.empty() || state_ != kConnected) {
+        return;
+    }
+    inputBuffer_.append(pendingInput.data(), pendingInput.size());
+    TimeStamp now = TimeStamp::now();
+    messageCallback_(shared_from_this(), &inputBuffer_, now);
+    releaseInputIfIdle(now);
+}
+
 void TcpConnection::connectEstablished() {
     setState(kConnected);
     channel_->tie(shared_from_this());
-    channel_->enableReading();  // 向poller注册channel的EPOLLIN读事件
+    if (reading_) {
+        channel_->enableReading();  // 向poller注册channel的EPOLLIN读事件
+    }
+    if (edgeTriggered_) {
+        channel_->enableWriting();  // ET模式下EPOLLOUT常驻，部分写入时无需再epoll_ctl MOD
+    }
+    startIdleTimers();
     // 新连接建立 执行回调
     connectionCallback_(shared_from_this());
 }
@@ -84,14 +308,27 @@ void TcpConnection::connectDestroyed() {
         connectionCallback_(shared_from_this());  // 将 channel 中的事件从 poller 中删除
     }
     channel_->remove();  // 将 channel 从 poller 中删除
+    cancelIdleTimers();
+    cancelFileTransfers();
+    // 未处理/未发出的数据丢弃，存储在loop线程归还slabPool
+    inputBuffer_.retrieveAll();
+    inputBuffer_.releaseStorage();
+    outputBuffer_.retrieveAll();
 }
 
 // 读是相对服务器而言的 当对端客户端有数据到达 服务器端检测到 EPOLL_IN 就会触发该fd上的回调 handleRead取读走对端发来的数据
 void TcpConnection::handleRead(TimeStamp receiveTime) {
+    if (edgeTriggered_) {
+        handleReadEdgeTriggered(receiveTime);
+        return;
+    }
     int saveErrno = 0;
-    ssize_t n = inputBuffer_.readFd(channel_->getFd(), &saveErrno);
+    // 单次最多读eventByteBudget_字节，剩余数据LT模式下一轮poll会再次就绪，期间同一loop上的其他连接得以处理
+    ssize_t n = inputBuffer_.readFd(channel_->getFd(), &saveErrno, eventByteBudget_, loop_->scratchBuffer(), EventLoop::kScratchBufferSize);
     if (n > 0) {
+        touchRead();
         messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+        releaseInputIfIdle(receiveTime);
     } else if (n == 0) {
         handleClose();
     } else {
@@ -101,13 +338,49 @@ void TcpConnection::handleRead(TimeStamp receiveTime) {
     }
 }
 
+// 上层处理完全部输入时立即归还存储；残留半个消息时等连接空闲kInputShrinkDelay秒后再按实际数据收缩
+void TcpConnection::releaseInputIfIdle(TimeStamp receiveTime) {
+    if (inputBuffer_.readableBytes() == 0) {
+        inputBuffer_.releaseStorage();
+        return;
+    }
+    lastReadTime_ = receiveTime;
+    if (!inputShrinkScheduled_) {
+        inputShrinkScheduled_ = true;
+        scheduleInputShrink(kInputShrinkDelay);
+    }
+}
+
+void TcpConnection::scheduleInputShrink(double delay) {
+    std::weak_ptr<TcpConnection> weakSelf = shared_from_this();
+    loop_->runAfter(delay, [weakSelf]() {
+        TcpConnectionPtr self = weakSelf.lock();
+        if (!self) {
+            return;
+        }
+        double idle = timeDifference(TimeStamp::now(), self->lastReadTime_);
+        if (self->state_ == kDisconnected || self->inputBuffer_.readableBytes() == 0) {
+            self->inputShrinkScheduled_ = false;
+        } else if (idle >= kInputShrinkDelay) {
+            self->inputShrinkScheduled_ = false;
+            self->inputBuffer_.shrinkToFit();
+        } else {
+            self->scheduleInputShrink(kInputShrinkDelay - idle);  // 期间又有数据到达，顺延
+        }
+    });
+}
+
 void TcpConnection::handleWrite() {
+    if (edgeTriggered_) {
+        handleWriteEdgeTriggered();
+        return;
+    }
     if (channel_->isWriting()) {
         int saveErrno = 0;
-        ssize_t n = outputBuffer_.writeFd(channel_->getFd(), &saveErrno);
-        if (n > 0) {
-            outputBuffer_.retrieve(n);  // 从缓冲区读取 reabable 区域数据移动到 readIndex 下标
-            if (outputBuffer_.readableBytes() == 0) {
+        ssize_t n = writeOutput(&saveErrno, SIZE_MAX);
+        if (n >= 0) {  // 0：文件源到达EOF且之后没有数据
+            checkBackpressure();  // 写到低水位以下时恢复读
+            if (!hasPendingOutput()) {
                 channel_->disableWriting();
                 if (writeCompleteCallback_) {
                     loop_->queueInLoop([self = shared_from_this()] { self->writeCompleteCallback_(self); });
@@ -116,7 +389,7 @@ void TcpConnection::handleWrite() {
                     shutdownInLoop();
                 }
             }
-        } else {
+        } else if (saveErrno != EAGAIN && saveErrno != EWOULDBLOCK) {
             LOG_ERROR("TcpConnection::handleWrite");
         }
     } else {
@@ -124,10 +397,86 @@ void TcpConnection::handleWrite() {
     }
 }
 
+// ET模式只在状态变化时通知一次，必须读到EAGAIN为止，否则剩余数据不会再次触发
+void TcpConnection::handleReadEdgeTriggered(TimeStamp receiveTime) {
+    size_t total = 0;
+    int saveErrno = 0;
+    ssize_t n = 0;
+    while (total < eventByteBudget_) {
+        n = inputBuffer_.readFd(channel_->getFd(), &saveErrno, eventByteBudget_ - total, loop_->scratchBuffer(), EventLoop::kScratchBufferSize);
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+    }
+    if (total > 0) {
+        touchRead();
+        messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);  // 一次事件只上报一次，包含本次读到的全部数据
+        releaseInputIfIdle(receiveTime);
+    }
+    if (n == 0) {
+        handleClose();
+    } else if (n < 0) {
+        if (saveErrno != EAGAIN && saveErrno != EWOULDBLOCK) {
+            errno = saveErrno;
+            LOG_ERROR("TcpConnection::handleRead");
+            handleError();
+        }
+    } else {
+        // 预算耗尽但socket中可能还有数据：让出给同一loop上的其他连接，本轮循环末尾继续读
+        loop_->queueInLoop([self = shared_from_this()]() {
+            if ((self->state_ == kConnected || self->state_ == kDisconnecting) && self->channel_->isReading()) {  // 期间可能已暂停读
+                self->handleRead(TimeStamp::now());
+            }
+        });
+    }
+}
+
+// EPOLLOUT常驻：没有待发送数据时的可写通知直接忽略；有数据时写到EAGAIN为止
+void TcpConnection::handleWriteEdgeTriggered() {
+    size_t total = 0;
+    bool hadOutput = hasPendingOutput();
+    while (hasPendingOutput() && total < eventByteBudget_) {
+        int saveErrno = 0;
+        ssize_t n = writeOutput(&saveErrno, eventByteBudget_ - total);
+        if (n < 0) {
+            if (saveErrno != EAGAIN && saveErrno != EWOULDBLOCK) {
+                LOG_ERROR("TcpConnection::handleWrite");
+            }
+            checkBackpressure();
+            return;  // 内核发送缓冲区已满（或文件源暂无数据），等待下一次EPOLLOUT边沿（或源可读）
+        }
+        total += n;
+    }
+    checkBackpressure();
+    if (hasPendingOutput()) {
+        // 预算耗尽，本轮循环末尾继续写
+        loop_->queueInLoop([self = shared_from_this()]() {
+            if (self->state_ == kConnected || self->state_ == kDisconnecting) {
+                self->handleWrite();
+            }
+        });
+    } else if (hadOutput) {
+        if (writeCompleteCallback_) {
+            loop_->queueInLoop([self = shared_from_this()] { self->writeCompleteCallback_(self); });
+        }
+        if (state_ == kDisconnecting) {
+            shutdownInLoop();
+        }
+    }
+}
+
+// 发送队列（缓冲数据与文件）非空即在发送中；LT模式下等待文件源可读期间写事件是关闭的，不能以此判断
+bool TcpConnection::isSending() const {
+    return hasPendingOutput();
+}
+
 void TcpConnection::handleClose() {
     LOG_INFO("TcpConnection::handleClose fd = %d state = %d\n", channel_->getFd(), (int) state_);
     setState(kDisconnected);
     channel_->disableAll();
+    cancelIdleTimers();
+    cancelFileTransfers();
 
     TcpConnectionPtr connPtr(shared_from_this());
     connectionCallback_(connPtr);  // 连接回调
@@ -135,6 +484,8 @@ void TcpConnection::handleClose() {
 }
 
 void TcpConnection::handleError() {
+    // 错误队列不为空时EPOLLERR持续就绪：只要开启过零拷贝就读空，不论是否还有等待中的发送（迟到、合并的通知）
+    bool zeroCopyCompleted = zeroCopySocket_ && readZeroCopyCompletions();
     int optval;
     socklen_t optlen = sizeof optval;
     int err = 0;
@@ -143,10 +494,14 @@ void TcpConnection::handleError() {
     } else {
         err = optval;
     }
+    if (zeroCopyCompleted && err == 0) {
+        return;  // 只是零拷贝完成通知
+    }
     LOG_ERROR("TcpConnection::handleError name: %s - SO_ERROR: %d\n", name_.c_str(), err);
 }
 
-void TcpConnection::sendInLoop(const void* data, size_t len) {
+// shared非空时data/len即其内容：剩余部分以引用方式挂到发送队列，不复制
+void TcpConnection::sendInLoop(const void* data, size_t len, const SharedSlice* shared) {
     ssize_t nwrote = 0;
     size_t remaining = len;
     bool faultError = false;
@@ -156,11 +511,16 @@ void TcpConnection::sendInLoop(const void* data, size_t len) {
         // return;
     }
     // 第一次开始写数据或缓冲区没有带发送数据
-    if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
+    if (!isSending() && outputBuffer_.readableBytes() == 0) {
         // nwrote = ::write(channel_->getFd(), data, len); // 如果对端关闭连接，此处调用write()会触发SIGPIPE,默认终止程序
-        nwrote = ::send(channel_->getFd(), data, len, MSG_NOSIGNAL);
+        if (shared && zeroCopyThreshold_ > 0 && len >= zeroCopyThreshold_) {
+            nwrote = sendZeroCopy(static_cast<const char*>(data), len, *shared);
+        } else {
+            nwrote = ::send(channel_->getFd(), data, len, MSG_NOSIGNAL);
+        }
         if (nwrote >= 0) {
             remaining = len - nwrote;
+            touchWrite();
             auto self = shared_from_this();
             if (remaining == 0 && writeCompleteCallback_) {
                 loop_->queueInLoop([self]() {
@@ -188,9 +548,14 @@ void TcpConnection::sendInLoop(const void* data, size_t len) {
                     self->highWaterMarkCallback_(self, oldLen + remaining);
                 });
             }
-            outputBuffer_.append(static_cast<const char*>(data) + nwrote, remaining);
+            if (shared) {
+                outputBuffer_.appendShared(shared->slice(nwrote));
+            } else {
+                outputBuffer_.append(static_cast<const char*>(data) + nwrote, remaining);
+            }
+            checkBackpressure();
         }
-        if (!channel_->isWriting()) { // 这里需要注册channel的写事件 否则poller不会给channel通知epollout
+        if (!channel_->isWriting() && !waitingForSource()) { // 这里需要注册channel的写事件 否则poller不会给channel通知epollout
             channel_->enableWriting();
         }
     }
@@ -200,48 +565,314 @@ void TcpConnection::sendInLoop(const void* data, size_t len) {
     }
 }
 
-void TcpConnection::shutdownInLoop() {
-    if (!channel_->isWriting()){
-        socket_->shutdownWrite();
+// appendToOutput追加数据之后：原本没有排队的数据时立即写一次，写不完的等EPOLLOUT
+void TcpConnection::outputAppended(size_t oldLen, bool wasSending) {
+    size_t newLen = outputBuffer_.readableBytes();
+    if (newLen == oldLen) {
+        return;
     }
+    if (newLen >= highWaterMark_ && oldLen < highWaterMark_ && highWaterMarkCallback_) {
+        loop_->queueInLoop([self = shared_from_this(), newLen] { self->highWaterMarkCallback_(self, newLen); });
+    }
+    checkBackpressure();
+    if (wasSending || state_ == kDisconnected) {
+        return;  // 已在等待EPOLLOUT，届时一并发出
+    }
+    startOutput();
 }
 
-void TcpConnection::sendFileInLoop(int fileDescriptor, off_t offset, size_t count) {
-    ssize_t bytesSent = 0; // 发送了多少字节数
-    size_t remaining = count; // 还要多少数据要发送
-    bool faultError = false; // 错误的标志位
+// 原本没有待发送数据时立即写（最多一个事件预算），写不完的等EPOLLOUT
+void TcpConnection::startOutput() {
+    size_t total = 0;
+    int saveErrno = 0;
+    ssize_t n = 0;
+    while (hasPendingOutput() && total < eventByteBudget_) {
+        n = writeOutput(&saveErrno, eventByteBudget_ - total);
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+    }
+    checkBackpressure();
+    if (n < 0 && saveErrno != EAGAIN && saveErrno != EWOULDBLOCK) {
+        LOG_ERROR("TcpConnection::startOutput write error");
+        if (saveErrno == EPIPE || saveErrno == ECONNRESET) {
+            handleClose();
+            return;
+        }
+    }
+    if (!hasPendingOutput()) {
+        if (writeCompleteCallback_) {
+            loop_->queueInLoop([self = shared_from_this()] { self->writeCompleteCallback_(self); });
+        }
+    } else if (!edgeTriggered_) {
+        if (!channel_->isWriting() && !waitingForSource()) {
+            channel_->enableWriting();
+        }
+    } else if (n > 0) {
+        // 预算耗尽而socket仍可写，不会再有EPOLLOUT边沿：本轮循环末尾继续写
+        loop_->queueInLoop([self = shared_from_this()]() {
+            if (self->state_ == kConnected || self->state_ == kDisconnecting) {
+                self->handleWrite();
+            }
+        });
+    }
+}
 
-    if (state_ == kDisconnecting) { // 表示此时连接已经断开就不需要发送数据了
-        LOG_ERROR("disconnected, give up writing");
+/**
+ * 按顺序写出发送队列：排在第一个文件之前的缓冲数据 => 文件 => 下一段缓冲数据 => ...，每次调用只推进其中一段。
+ * 返回写出的字节数；队列为空返回0；socket已满或文件源暂无数据时返回-1且*saveErrno为EAGAIN。
+ **/
+ssize_t TcpConnection::writeOutput(int* saveErrno, size_t maxBytes) {
+    while (!fileTransfers_.empty()) {
+        FileTransfer& file = *fileTransfers_.front();
+        if (file.bytesBefore > 0) {
+            ssize_t n = writeBuffered(saveErrno, std::min(maxBytes, file.bytesBefore));
+            if (n > 0) {
+                file.bytesBefore -= n;
+            }
+            return n;
+        }
+        ssize_t n = transferFile(file, saveErrno, maxBytes);
+        if (file.remaining == 0) {
+            fileTransfers_.erase(fileTransfers_.begin());
+        }
+        if (n != 0) {
+            return n;
+        }
+        // 源已到EOF且本次没有写出数据：继续下一段
+    }
+    return writeBuffered(saveErrno, maxBytes);
+}
+
+// 发送队列头部是足够大的共享段时零拷贝发送，其余情况照常writev；写出的部分从缓冲区移除
+ssize_t TcpConnection::writeBuffered(int* saveErrno, size_t maxBytes) {
+    ssize_t n;
+    SharedSlice front = zeroCopyThreshold_ > 0 ? outputBuffer_.frontShared() : SharedSlice();
+    if (zeroCopyThreshold_ > 0 && front.size() >= zeroCopyThreshold_) {
+        n = sendZeroCopy(front.data(), std::min(front.size(), maxBytes), front);
+        if (n < 0) {
+            *saveErrno = errno;
+        }
+    } else {
+        n = outputBuffer_.writeFd(channel_->getFd(), saveErrno, maxBytes);
+    }
+    if (n > 0) {
+        outputBuffer_.retrieve(n);
+        touchWrite();
+    }
+    return n;
+}
+
+/**
+ * 把文件的下一部分写入socket，偏移量由文件状态保存（sendfile直接更新），不再随回调捕获。
+ *  - 普通文件：sendfile
+ *  - 管道：splice直接从管道到socket
+ *  - socket：splice先到中转管道，再从管道到socket
+ * 源暂无数据时在源fd上等待可读（LT模式期间关闭EPOLLOUT，避免空转），返回-1且*saveErrno为EAGAIN。
+ * 源提前EOF时按已发送的部分结束；源出错时关闭连接，避免对端收到截断后错位的数据流。
+ **/
+ssize_t TcpConnection::transferFile(FileTransfer& file, int* saveErrno, size_t maxBytes) {
+    const int sockfd = channel_->getFd();
+    size_t len = std::min(file.remaining, maxBytes);
+    ssize_t n = 0;
+    bool sourceEmpty = false;
+    if (file.kind == FileTransfer::kRegularFile) {
+        n = ::sendfile(sockfd, file.fd, &file.offset, len);
+    } else if (file.kind == FileTransfer::kPipe) {
+        n = ::splice(file.fd, nullptr, sockfd, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n < 0 && errno == EAGAIN) {
+            int available = 0;
+            sourceEmpty = ::ioctl(file.fd, FIONREAD, &available) == 0 && available == 0;  // 区分管道空与socket满
+            errno = EAGAIN;
+        }
+    } else {
+        if (file.pipeBytes == 0) {
+            ssize_t m = ::splice(file.fd, nullptr, file.pipeFds[1], nullptr, std::min(len, kSplicePipeSize), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (m > 0) {
+                file.pipeBytes = m;
+            } else if (m == 0) {
+                file.remaining = 0;  // 对端关闭
+                return 0;
+            } else {
+                sourceEmpty = errno == EAGAIN;
+                n = -1;
+            }
+        }
+        if (file.pipeBytes > 0) {
+            n = ::splice(file.pipeFds[0], nullptr, sockfd, nullptr, std::min(len, file.pipeBytes), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0) {
+                file.pipeBytes -= n;
+            }
+        }
+    }
+
+    if (n > 0) {
+        file.remaining -= n;
+        touchWrite();
+    } else if (n == 0) {
+        file.remaining = 0;  // 源提前到达EOF
+    } else if (sourceEmpty) {
+        waitForSource(file);
+        *saveErrno = EAGAIN;
+    } else if (errno == EAGAIN || errno == EPIPE || errno == ECONNRESET) {
+        *saveErrno = errno;  // socket侧的情况，与普通写一致处理
+    } else {
+        *saveErrno = errno;
+        LOG_ERROR("TcpConnection::transferFile fd = %d source error: %s", file.fd, strerror(errno));
+        file.remaining = 0;
+        forceClose();
+    }
+    return n;
+}
+
+void TcpConnection::waitForSource(FileTransfer& file) {
+    if (!file.sourceChannel) {
+        file.sourceChannel.reset(new Channel(loop_, file.fd));
+        file.sourceChannel->tie(shared_from_this());
+        file.sourceChannel->setReadCallback([this](TimeStamp) { sourceReadable(); });
+    }
+    file.sourceChannel->enableReading();
+    if (!edgeTriggered_ && channel_->isWriting()) {
+        channel_->disableWriting();
+    }
+}
+
+// 源可读：恢复写。不在回调中直接写，写完时会销毁正在回调的源Channel
+void TcpConnection::sourceReadable() {
+    if (fileTransfers_.empty() || !fileTransfers_.front()->sourceChannel) {
         return;
     }
-    // 表示Channel第一次开始写数据或者outputBuffer缓冲区中没有数据
-    if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
-        bytesSent = sendfile(socket_->getSocketFd(), fileDescriptor, &offset, remaining);
-        if (bytesSent >= 0) {
-            remaining -= bytesSent;
-            if (remaining == 0 && writeCompleteCallback_) {
-                // remaining为0意味着数据正好全部发送完，就不需要给其设置写事件的监听。
-                auto self = shared_from_this();
-                loop_->queueInLoop([self]() {
-                    self->writeCompleteCallback_(self);
-                });
+    fileTransfers_.front()->sourceChannel->disableReading();
+    if (!edgeTriggered_) {
+        if (!channel_->isWriting()) {
+            channel_->enableWriting();
+        }
+    } else {
+        loop_->queueInLoop([self = shared_from_this()]() {
+            if (self->state_ == kConnected || self->state_ == kDisconnecting) {
+                self->handleWrite();
+            }
+        });
+    }
+}
+
+// 源fd归调用方所有，不关闭。源Channel立即从Poller移除；本轮poll返回的活跃列表中可能还有它（连接与源同时就绪），
+// Channel对象留到本轮事件处理完之后再析构
+void TcpConnection::cancelFileTransfers() {
+    for (const auto& file : fileTransfers_) {
+        if (file->sourceChannel) {
+            file->sourceChannel->disableAll();
+            file->sourceChannel->remove();
+            loop_->queueInLoop([channel = std::move(file->sourceChannel)]() {});
+        }
+    }
+    fileTransfers_.clear();
+}
+
+bool TcpConnection::waitingForSource() const {
+    return !fileTransfers_.empty() && fileTransfers_.front()->sourceChannel && fileTransfers_.front()->sourceChannel->isReading();
+}
+
+// 内核只对成功发出数据的调用分配序号，序号按调用次数递增；owner的存储保留到对应的完成通知到达
+ssize_t TcpConnection::sendZeroCopy(const char* data, size_t len, const SharedSlice& owner) {
+    ssize_t n = ::send(channel_->getFd(), data, len, MSG_NOSIGNAL | MSG_ZEROCOPY);
+    if (n < 0 && errno == ENOBUFS) {
+        // 锁定页面超出optmem限制，本次退回普通发送
+        n = ::send(channel_->getFd(), data, len, MSG_NOSIGNAL);
+    } else if (n > 0) {
+        zeroCopyPending_.push_back(PendingZeroCopy{zeroCopyNextId_++, owner.storage()});
+    }
+    return n;
+}
+
+// 完成通知以EPOLLERR的形式到达：读空错误队列，释放序号在[lo, hi]内的存储
+bool TcpConnection::readZeroCopyCompletions() {
+    bool completed = false;
+    for (;;) {
+        char control[128];
+        msghdr msg = {};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+        if (::recvmsg(channel_->getFd(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            break;  // EAGAIN：队列已空
+        }
+        for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) && !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+                continue;
             }
-        } else {  // bytesSent < 0
-            if (errno != EWOULDBLOCK) {  // 如果是非阻塞没有数据返回错误这个是正常显现等同于EAGAIN，否则就异常情况
-                LOG_ERROR("TcpConnection::sendFileInLoop");
+            const sock_extended_err* serr = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cm));
+            if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
             }
-            if (errno == EPIPE || errno == ECONNRESET) {
-                faultError = true;
+            completed = true;
+            uint32_t lo = serr->ee_info;
+            uint32_t hi = serr->ee_data;
+            zeroCopyPending_.erase(std::remove_if(zeroCopyPending_.begin(), zeroCopyPending_.end(),
+                                                  [lo, hi](const PendingZeroCopy& p) { return p.id - lo <= hi - lo; }),  // 无符号差值处理序号回绕
+                                   zeroCopyPending_.end());
+            if ((serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) && zeroCopyThreshold_ > 0) {
+                // 内核还是复制了，零拷贝只多了锁页和通知的开销
+                LOG_INFO("TcpConnection %s: kernel copied zerocopy send, falling back to regular send", name_.c_str());
+                zeroCopyThreshold_ = 0;
             }
         }
     }
-    // 处理剩余数据
-    if (!faultError && remaining > 0) {
-        // 继续发送剩余数据
-        auto self = shared_from_this();
-        loop_->queueInLoop([self, fileDescriptor, offset, remaining]() {
-            self->sendFileInLoop(fileDescriptor, offset, remaining);
-        });
+    return completed;
+}
+
+void TcpConnection::shutdownInLoop() {
+    if (!isSending()) {
+        socket_->shutdownWrite();
+    }
+}
+
+// 文件排在已缓冲的数据之后，之后send的数据排在文件之后；由EPOLLOUT（或源可读）驱动续传
+void TcpConnection::sendFileInLoop(int fileDescriptor, off_t offset, size_t count) {
+    if (state_ != kConnected) { // 表示此时连接已经断开就不需要发送数据了
+        LOG_ERROR("disconnected, give up writing");
+        return;
+    }
+    if (count == 0) {
+        return;
+    }
+    std::unique_ptr<FileTransfer> file(new FileTransfer(fileDescriptor, offset, count));
+    struct stat st;
+    bool known = ::fstat(fileDescriptor, &st) == 0;
+    if (known && S_ISFIFO(st.st_mode)) {
+        file->kind = FileTransfer::kPipe;
+    } else if (known && S_ISSOCK(st.st_mode)) {
+        file->kind = FileTransfer::kSocket;
+        if (::pipe2(file->pipeFds, O_NONBLOCK | O_CLOEXEC) < 0) {
+            LOG_ERROR("TcpConnection::sendFileInLoop pipe2 failed: %s", strerror(errno));
+            return;
+        }
+    }
+    if (file->kind != FileTransfer::kRegularFile) {
+        ::fcntl(fileDescriptor, F_SETFL, ::fcntl(fileDescriptor, F_GETFL) | O_NONBLOCK);  // 源暂无数据时不能阻塞loop
+    }
+    file->bytesBefore = outputBuffer_.readableBytes();
+    for (const auto& queued : fileTransfers_) {
+        file->bytesBefore -= queued->bytesBefore;
+    }
+    bool wasSending = isSending();
+    fileTransfers_.push_back(std::move(file));
+    if (!wasSending) {
+        startOutput();
+    }
+}
+
+TcpConnection::FileTransfer::FileTransfer(int fileDescriptor, off_t off, size_t count) :
+    fd(fileDescriptor), kind(kRegularFile), offset(off), remaining(count), bytesBefore(0), pipeFds{-1, -1}, pipeBytes(0) {}
+
+// 在loop线程析构：发送完成时，或连接关闭时由cancelFileTransfers清空（源Channel已提前移除）
+TcpConnection::FileTransfer::~FileTransfer() {
+    if (sourceChannel) {
+        sourceChannel->disableAll();
+        sourceChannel->remove();
+    }
+    if (pipeFds[0] >= 0) {
+        ::close(pipeFds[0]);
+        ::close(pipeFds[1]);
     }
 }
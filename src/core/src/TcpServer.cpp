@@ -2,9 +2,12 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <functional>
+#include <future>
 
 #include "Logger.h"
+#include "Socket.h"
 #include "TcpConnection.h"
 
 namespace {
@@ -14,26 +17,82 @@ EventLoop* CheckLoopNotNull(EventLoop* loop) {
     }
     return loop;
 }
+
+// 在loop线程执行func并等待完成
+void runInLoopAndWait(EventLoop* loop, const std::function<void()>& func) {
+    if (loop->isInLoopThread()) {
+        func();
+        return;
+    }
+    std::promise<void> done;
+    loop->runInLoop([&func, &done]() {
+        func();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
 }  // namespace
 
 TcpServer::TcpServer(EventLoop* loop, const InetAddress& listenAddr, const std::string& nameArg, Option option) :
     loop_(CheckLoopNotNull(loop)),
     ipPort_(listenAddr.toIpPort()),
     name_(nameArg),
+    listenAddr_(listenAddr),
     acceptor_(new Acceptor(loop, listenAddr, option == kReusePort)),
     threadPool_(new EventLoopThreadPool(loop, name_)),
     nextConnId_(1),
     started_(0),
+    edgeTriggered_(false),
+    eventByteBudget_(TcpConnection::kDefaultEventByteBudget),
+    backpressureHighWaterMark_(0),
+    backpressureLowWaterMark_(0),
+    readIdleTimeout_(0),
+    writeIdleTimeout_(0),
+    lifetimeLimit_(0),
+    acceptorPerLoop_(false),
+    cpuSteering_(false),
     connectionCallback_(),
     messageCallback_() {  
+    setupAcceptor();
+}
+
+TcpServer::TcpServer(EventLoop* loop, int listenFd, const std::string& nameArg) :
+    loop_(CheckLoopNotNull(loop)),
+    ipPort_(Socket::getLocalAddr(listenFd).toIpPort()),
+    name_(nameArg),
+    listenAddr_(Socket::getLocalAddr(listenFd)),
+    acceptor_(new Acceptor(loop, listenFd)),
+    threadPool_(new EventLoopThreadPool(loop, name_)),
+    nextConnId_(1),
+    started_(0),
+    edgeTriggered_(false),
+    eventByteBudget_(TcpConnection::kDefaultEventByteBudget),
+    backpressureHighWaterMark_(0),
+    backpressureLowWaterMark_(0),
+    readIdleTimeout_(0),
+    writeIdleTimeout_(0),
+    lifetimeLimit_(0),
+    acceptorPerLoop_(false),
+    cpuSteering_(false) {
+    setupAcceptor();
+}
+
+void TcpServer::setupAcceptor() {
     // 当有新用户连接时，Acceptor类中绑定的acceptChannel_会有读事件发生，执行handleRead()调用TcpServer::newConnection回调
     acceptor_->setNewConnectionCallback([this](int sockfd, const InetAddress& listenAddr) { this->newConnection(sockfd, listenAddr); });
+    acceptor_->setNewConnectionBatchCallback([this](const std::vector<Acceptor::AcceptedSocket>& batch) { this->newConnections(batch); });
 }
 
 TcpServer::~TcpServer() {
+    // 先在各自loop中关闭监听，之后不会再有新连接加入
+    for (auto& acceptor : loopAcceptors_) {
+        runInLoopAndWait(acceptor->getLoop(), [&acceptor]() { acceptor.reset(); });
+    }
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
     for (auto& item : connections_) {
         TcpConnectionPtr conn(item.second);
         item.second.reset();  // 复位原始的智能指针，将栈空间的TcpConnectionPtr conn指向该对象，超出作用域即可释放
+        conn->getLoop()->adjustConnectionCount(-1);
         conn->getLoop()->runInLoop([conn]() { conn->connectDestroyed(); });  // 销毁连接
     }
 }
@@ -44,21 +103,82 @@ void TcpServer::setThreadNum(int numThreads) {
     threadPool_->setThreadNum(numThreads_);
 }
 
+void TcpServer::setEdgeTriggered(bool on) {
+    edgeTriggered_ = on;
+    if (acceptor_) {  // 每loop Acceptor模式启动后acceptor_已关闭
+        acceptor_->setEdgeTriggered(on);
+    }
+}
+
 // 开启服务器监听
 void TcpServer::start() {
     if (started_.fetch_add(1) == 0) {  // 防止一个TcpServer对象被start多次
         threadPool_->start(threadInitCallback_);  // 启动底层的loop线程池
         loop_->runInLoop([this] {  // 依赖TcpServer对象保持存活
-            acceptor_->listen();
+            if (acceptorPerLoop_) {
+                startLoopAcceptors();
+            } else {
+                acceptor_->listen();
+            }
+        });
+    }
+}
+
+// 在mainLoop线程执行：关闭构造时绑定的监听socket，依次在每个loop中创建并listen各自的Acceptor
+// 逐个同步创建保证组内socket的顺序与loop顺序一致，cBPF返回的下标才能对应到第i个loop
+void TcpServer::startLoopAcceptors() {
+    acceptor_.reset();
+    for (EventLoop* ioLoop : threadPool_->getAllLoops()) {
+        runInLoopAndWait(ioLoop, [this, ioLoop]() {
+            std::unique_ptr<Acceptor> acceptor(new Acceptor(ioLoop, listenAddr_, true));
+            acceptor->setEdgeTriggered(edgeTriggered_);
+            acceptor->setNewConnectionCallback([this, ioLoop](int sockfd, const InetAddress& peerAddr) { this->newConnectionInLoop(ioLoop, sockfd, peerAddr); });
+            acceptor->listen();
+            loopAcceptors_.push_back(std::move(acceptor));
         });
     }
+    if (cpuSteering_ && !loopAcceptors_.empty()) {
+        loopAcceptors_.front()->setCpuSteering(static_cast<int>(loopAcceptors_.size()));
+    }
 }
 
 // 每当有新用户连接时，acceptor会执行回调操作
-// 将mainLoop接收到的强求连接通过回调轮询分发给subLoop
+// 将mainLoop接收到的强求连接通过回调按分发策略交给subLoop
 void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr) {
-    // 轮询算法：选择一个subLoop来管理connfd对应的channel
-    EventLoop* ioLoop = threadPool_->getNextLoop();
+    // 按分发策略选择一个subLoop来管理connfd对应的channel
+    newConnectionInLoop(threadPool_->getNextLoop(peerAddr), sockfd, peerAddr);
+}
+
+// 一批连接按目标loop分组，每个loop只转交一次（一次queueInLoop、至多一次唤醒），而不是每个连接一次
+void TcpServer::newConnections(const std::vector<Acceptor::AcceptedSocket>& batch) {
+    std::vector<std::pair<EventLoop*, std::vector<TcpConnectionPtr>>> handoffs;
+    for (const Acceptor::AcceptedSocket& accepted : batch) {
+        EventLoop* ioLoop = threadPool_->getNextLoop(accepted.peerAddr);
+        TcpConnectionPtr conn = createConnection(ioLoop, accepted.sockfd, accepted.peerAddr);
+        auto it = std::find_if(handoffs.begin(), handoffs.end(), [ioLoop](const std::pair<EventLoop*, std::vector<TcpConnectionPtr>>& handoff) { return handoff.first == ioLoop; });
+        if (it == handoffs.end()) {
+            handoffs.emplace_back(ioLoop, std::vector<TcpConnectionPtr>());
+            it = handoffs.end() - 1;
+        }
+        it->second.push_back(std::move(conn));
+    }
+    for (auto& handoff : handoffs) {
+        handoff.first->runInLoop([conns = std::move(handoff.second)]() {
+            for (const TcpConnectionPtr& conn : conns) {
+                conn->connectEstablished();
+            }
+        });
+    }
+}
+
+void TcpServer::newConnectionInLoop(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr) {
+    TcpConnectionPtr conn = createConnection(ioLoop, sockfd, peerAddr);
+    // ioLoop->runInLoop(std::bind(&TcpConnection::connectEstablished, conn));
+    ioLoop->runInLoop([conn]() { conn->connectEstablished(); });
+}
+
+TcpConnectionPtr TcpServer::createConnection(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr) {
+    ioLoop->adjustConnectionCount(1);  // 立即计入，连续分发时后续选择即可看到
 
     // ++nextConnId_;  // 没有设置为原子类是因为其只在mainloop中执行，不存在线程安全问题
     int connId = nextConnId_.fetch_add(1, std::memory_order_relaxed); // 即使如此依然需要全部采取原子操作保持一致性
@@ -67,37 +187,78 @@ void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr) {
     std::string connName = name_ + buf;
     LOG_INFO("TcpServer::newConnection [%s] - new connection [%s] from %s\n", name_.c_str(), connName.c_str(), peerAddr.toIpPort().c_str());
 
-    sockaddr_in local;
-    socklen_t addrLen = sizeof(local);
-    ::memset(&local, 0, addrLen);
-    if (::getsockname(sockfd, (sockaddr*) &local, &addrLen) < 0) {
-        LOG_ERROR("socket::getLocalAddr");
-    }
-    InetAddress localAddr(local);
+    InetAddress localAddr(Socket::getLocalAddr(sockfd));
     TcpConnectionPtr conn(new TcpConnection(ioLoop, connName, sockfd, localAddr, peerAddr));
-    connections_[connName] = conn;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        connections_[connName] = conn;
+    }
 
     // 设置回调函数：TcpServer => TcpConnection
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
     conn->setWriteCompleteCallback(writeCompleteCallback_);
+    conn->setEdgeTriggered(edgeTriggered_);
+    conn->setEventByteBudget(eventByteBudget_);
+    conn->setIdleTimeouts(readIdleTimeout_, writeIdleTimeout_, lifetimeLimit_);
+    if (backpressureHighWaterMark_ > 0) {
+        conn->setReadBackpressure(backpressureHighWaterMark_, backpressureLowWaterMark_);
+    }
 
     // 设置关闭连接的回调
     // conn->setCloseCallback(std::bind(&TcpServer::removeConnection, this, std::placeholders::_1));
     conn->setCloseCallback([this](const TcpConnectionPtr& conn) { removeConnection(conn); });
-    // ioLoop->runInLoop(std::bind(&TcpConnection::connectEstablished, conn));
-    ioLoop->runInLoop([conn]() { conn->connectEstablished(); });
+    return conn;
+}
+
+void TcpServer::stopListening() {
+    acceptor_.reset();
+}
+
+void TcpServer::adoptConnection(int sockfd, const std::string& pendingInput) {
+    loop_->runInLoop([this, sockfd, pendingInput]() {
+        InetAddress peerAddr(Socket::getPeerAddr(sockfd));
+        EventLoop* ioLoop = threadPool_->getNextLoop(peerAddr);
+        TcpConnectionPtr conn = createConnection(ioLoop, sockfd, peerAddr);
+        ioLoop->runInLoop([conn, pendingInput]() {
+            conn->connectEstablished();
+            conn->restoreInput(pendingInput);
+        });
+    });
+}
+
+std::vector<TcpConnectionPtr> TcpServer::connectionList() {
+    std::vector<TcpConnectionPtr> conns;
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    conns.reserve(connections_.size());
+    for (const auto& item : connections_) {
+        conns.push_back(item.second);
+    }
+    return conns;
+}
+
+size_t TcpServer::connectionCount() {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    return connections_.size();
 }
 
 void TcpServer::removeConnection(const TcpConnectionPtr& conn) {
+    if (acceptorPerLoop_) {  // 连接由所在loop自行管理，无需转到mainLoop
+        removeConnectionInLoop(conn);
+        return;
+    }
     // loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
     loop_->runInLoop([this, conn]() { this->removeConnectionInLoop(conn); });
 }
 
 void TcpServer::removeConnectionInLoop(const TcpConnectionPtr& conn) {
     LOG_INFO("TcpServer::removeConnectionInLoop [%s] - connection %s\n", name_.c_str(), conn->name().c_str());
-    connections_.erase(conn->name());
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        connections_.erase(conn->name());
+    }
     EventLoop* ioLoop = conn->getLoop();
+    ioLoop->adjustConnectionCount(-1);
     // ioLoop->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
     ioLoop->queueInLoop([conn] { conn->connectDestroyed(); });
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Thread.h"
 
+#include <pthread.h>
+
 #include <future>
 
 #include "CurrentThread.h"
@@ -25,6 +27,8 @@ void Thread::start() {
     auto tidFuture = tidPromise.get_future();
     thread_ = std::make_shared<std::thread>([this, promise = std::move(tidPromise)] () mutable {
         tid_ = CurrentThread::tid();
+        // 内核线程名最长15个字符，便于在top/perf/gdb中区分各个loop线程
+        ::pthread_setname_np(::pthread_self(), name_.substr(0, 15).c_str());
         promise.set_value(tid_);
         func_();
     });
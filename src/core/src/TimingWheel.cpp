@@ -0,0 +1,59 @@
+#include "TimingWheel.h"
+
+#include <cmath>
+
+#include "EventLoop.h"
+
+TimingWheel::TimingWheel(EventLoop* loop, double tick, size_t slots) :
+    loop_(loop), tick_(tick), slots_(slots), now_(std::make_shared<uint64_t>(0)), size_(0), ticking_(false) {}
+
+TimingWheel::~TimingWheel() {
+    if (ticking_) {
+        loop_->cancel(timerId_);
+    }
+}
+
+TimingWheel::EntryPtr TimingWheel::add(double timeout, Callback cb) {
+    // touch记录的是已经过的tick数，当前tick已过去一部分，多等一个tick保证至少空闲timeout秒
+    uint64_t ticks = static_cast<uint64_t>(std::ceil(timeout / tick_)) + 1;
+    EntryPtr entry(new Entry(now_, ticks, std::move(cb)));
+    place(entry, *now_ + entry->timeoutTicks_);
+    ++size_;
+    if (!ticking_) {
+        ticking_ = true;
+        timerId_ = loop_->runEvery(tick_, [this]() { onTick(); });  // 析构时取消
+    }
+    return entry;
+}
+
+void TimingWheel::place(const EntryPtr& entry, uint64_t deadline) {
+    slots_[deadline % slots_.size()].push_back(entry);
+}
+
+void TimingWheel::onTick() {
+    uint64_t now = ++*now_;
+    std::vector<EntryPtr> due;
+    due.swap(slots_[now % slots_.size()]);  // 回调中可能add/cancel，先取出本槽
+    for (const EntryPtr& entry : due) {
+        if (entry->cancelled_) {
+            --size_;
+            continue;
+        }
+        uint64_t deadline = entry->lastTouch_ + entry->timeoutTicks_;
+        if (deadline > now) {
+            place(entry, deadline);  // 期间touch过，或超时超过一圈
+            continue;
+        }
+        --size_;
+        entry->expired_ = true;
+        Callback cb;
+        cb.swap(entry->callback_);
+        cb();
+    }
+    if (size_ == 0 && ticking_) {  // 回调中可能已add新项
+        // 没有连接需要计时时不再每tick唤醒loop；tick计数暂停，之后add的项仍按相对tick计时
+        ticking_ = false;
+        loop_->cancel(timerId_);
+    }
+    // 取出的vector在这里释放；空闲时槽里没有项，不额外占内存
+}
@@ -0,0 +1,257 @@
+#include "UpstreamPool.h"
+
+#include <algorithm>
+
+#include "EventLoop.h"
+#include "Logger.h"
+#include "TcpClient.h"
+#include "TcpConnection.h"
+
+UpstreamPool::UpstreamPool(EventLoop* loop, const std::string& nameArg) :
+    loop_(loop),
+    name_(nameArg),
+    maxConnections_(kDefaultMaxConnections),
+    maxIdle_(kDefaultMaxIdle),
+    idleTimeout_(60.0),
+    connectTimeout_(3.0),
+    connectRetries_(2),
+    checkInterval_(1.0),
+    checking_(false),
+    nextClientId_(1)
+{
+}
+
+UpstreamPool::~UpstreamPool() {
+    if (checking_) {
+        loop_->cancel(checkTimer_);
+    }
+    for (auto& entry : upstreams_) {
+        for (auto& member : entry.second.members) {
+            // 连接可能被调用方继续持有，回调不能再指向已析构的池；池不再持有后由TcpClient析构关闭
+            if (member->conn) {
+                member->conn->setConnectionCallback([](const TcpConnectionPtr&) {});
+                member->conn.reset();
+            }
+            member->client.reset();
+        }
+    }
+}
+
+void UpstreamPool::acquire(const InetAddress& upstream, const AcquireCallback& cb) {
+    if (!checking_ && checkInterval_ > 0) {
+        checking_ = true;
+        checkTimer_ = loop_->runEvery(checkInterval_, [this]() { this->checkIdle(); });
+    }
+
+    std::string key = upstream.toIpPort();
+    Upstream& up = upstreams_[key];
+    up.addr = upstream;
+
+    // 有空闲连接或者已到上限时直接复用在途请求最少的连接，否则新建连接，避免排在忙碌连接之后
+    Member* best = leastInflight(up);
+    if (best && (best->inflight == 0 || up.members.size() >= maxConnections_)) {
+        ++best->inflight;
+        cb(best->conn);
+        return;
+    }
+    up.waiters.push_back(cb);
+    if (up.members.size() < maxConnections_) {
+        openConnection(key, up);
+    }
+}
+
+void UpstreamPool::release(const TcpConnectionPtr& conn) {
+    std::string key = conn->peerAddress().toIpPort();
+    Upstream* up = find(key);
+    if (!up) {
+        return;
+    }
+    Member* member = findMember(*up, conn);
+    if (!member || member->inflight == 0) {
+        return;
+    }
+    if (--member->inflight == 0) {
+        member->idleSince = TimeStamp::now();
+    }
+    dispatchWaiters(key, *up);
+    if (isIdle(*member) && idleCount(up->addr) > maxIdle_) {
+        closeMember(member);
+    }
+}
+
+size_t UpstreamPool::connectionCount(const InetAddress& upstream) const {
+    const Upstream* up = find(upstream.toIpPort());
+    if (!up) {
+        return 0;
+    }
+    return std::count_if(up->members.begin(), up->members.end(), [](const std::unique_ptr<Member>& m) { return m->conn && m->conn->connected(); });
+}
+
+size_t UpstreamPool::idleCount(const InetAddress& upstream) const {
+    const Upstream* up = find(upstream.toIpPort());
+    if (!up) {
+        return 0;
+    }
+    return std::count_if(up->members.begin(), up->members.end(), [](const std::unique_ptr<Member>& m) { return isIdle(*m); });
+}
+
+size_t UpstreamPool::inflight(const TcpConnectionPtr& conn) const {
+    const Upstream* up = find(conn->peerAddress().toIpPort());
+    if (!up) {
+        return 0;
+    }
+    for (const auto& member : up->members) {
+        if (member->conn == conn) {
+            return member->inflight;
+        }
+    }
+    return 0;
+}
+
+UpstreamPool::Upstream* UpstreamPool::find(const std::string& key) {
+    auto it = upstreams_.find(key);
+    return it == upstreams_.end() ? nullptr : &it->second;
+}
+
+const UpstreamPool::Upstream* UpstreamPool::find(const std::string& key) const {
+    auto it = upstreams_.find(key);
+    return it == upstreams_.end() ? nullptr : &it->second;
+}
+
+UpstreamPool::Member* UpstreamPool::leastInflight(Upstream& up) {
+    Member* best = nullptr;
+    for (auto& member : up.members) {
+        if (!member->conn || !member->conn->connected() || member->closing) {
+            continue;
+        }
+        if (!best || member->inflight < best->inflight) {
+            best = member.get();
+        }
+    }
+    return best;
+}
+
+UpstreamPool::Member* UpstreamPool::findMember(Upstream& up, const TcpConnectionPtr& conn) {
+    for (auto& member : up.members) {
+        if (member->conn == conn) {
+            return member.get();
+        }
+    }
+    return nullptr;
+}
+
+bool UpstreamPool::isIdle(const Member& member) {
+    return member.conn && member.conn->connected() && member.inflight == 0 && !member.closing;
+}
+
+void UpstreamPool::openConnection(const std::string& key, Upstream& up) {
+    std::unique_ptr<Member> member(new Member);
+    Member* m = member.get();
+    std::string clientName = name_ + ":" + key + "#" + std::to_string(nextClientId_++);
+    m->client.reset(new TcpClient(loop_, up.addr, clientName));
+    m->client->connector().setConnectTimeout(connectTimeout_);
+    m->client->connector().setMaxRetries(connectRetries_);
+    m->client->setConnectionCallback([this, key, m](const TcpConnectionPtr& conn) { this->onConnection(key, m, conn); });
+    if (messageCallback_) {
+        m->client->setMessageCallback(messageCallback_);
+    } else {
+        m->client->setMessageCallback([](const TcpConnectionPtr&, Buffer*, TimeStamp) {});
+    }
+    m->client->setConnectFailedCallback([this, key, m]() { this->onConnectFailed(key, m); });
+    ++up.connecting;
+    up.members.push_back(std::move(member));
+    m->client->connect();
+}
+
+void UpstreamPool::onConnection(const std::string& key, Member* member, const TcpConnectionPtr& conn) {
+    Upstream* up = find(key);
+    if (!up) {
+        return;
+    }
+    if (conn->connected()) {
+        --up->connecting;
+        member->conn = conn;
+        member->idleSince = TimeStamp::now();
+        LOG_INFO("UpstreamPool [%s] - %s connected\n", name_.c_str(), conn->name().c_str());
+        dispatchWaiters(key, *up);
+    } else {
+        LOG_INFO("UpstreamPool [%s] - %s closed with %zu in flight\n", name_.c_str(), conn->name().c_str(), member->inflight);
+        removeMember(key, member);
+        dispatchWaiters(key, *up);
+    }
+}
+
+void UpstreamPool::onConnectFailed(const std::string& key, Member* member) {
+    Upstream* up = find(key);
+    if (!up) {
+        return;
+    }
+    LOG_ERROR("UpstreamPool [%s] - connect to %s failed\n", name_.c_str(), key.c_str());
+    --up->connecting;
+    removeMember(key, member);
+    if (up->connecting == 0 && !leastInflight(*up)) {
+        // 没有可用连接也没有正在建立的连接，排队的请求全部失败，由调用方决定是否重试
+        std::deque<AcquireCallback> waiters;
+        waiters.swap(up->waiters);
+        for (const AcquireCallback& cb : waiters) {
+            cb(nullptr);
+        }
+        return;
+    }
+    dispatchWaiters(key, *up);
+}
+
+void UpstreamPool::removeMember(const std::string& key, Member* member) {
+    Upstream* up = find(key);
+    auto it = std::find_if(up->members.begin(), up->members.end(), [member](const std::unique_ptr<Member>& m) { return m.get() == member; });
+    if (it == up->members.end()) {
+        return;
+    }
+    // 正处于该成员TcpClient/Connector的回调中，延迟到pending functors阶段再析构
+    std::shared_ptr<Member> dying(it->release());
+    up->members.erase(it);
+    loop_->queueInLoop([dying]() {});
+}
+
+void UpstreamPool::dispatchWaiters(const std::string& key, Upstream& up) {
+    while (!up.waiters.empty()) {
+        Member* best = leastInflight(up);
+        if (!best) {
+            break;
+        }
+        if (best->inflight > 0 && up.connecting > 0) {
+            break;  // 留给正在建立的连接
+        }
+        AcquireCallback cb = std::move(up.waiters.front());
+        up.waiters.pop_front();
+        ++best->inflight;
+        cb(best->conn);
+    }
+    // 排队的请求没有连接可用（连接被关闭）时补建连接
+    if (!up.waiters.empty() && up.connecting == 0 && up.members.size() < maxConnections_) {
+        openConnection(key, up);
+    }
+}
+
+void UpstreamPool::closeMember(Member* member) {
+    member->closing = true;
+    member->conn->forceClose();  // 关闭后经onConnection移除
+}
+
+void UpstreamPool::checkIdle() {
+    TimeStamp now = TimeStamp::now();
+    for (auto& entry : upstreams_) {
+        for (auto& member : entry.second.members) {
+            if (!isIdle(*member)) {
+                continue;
+            }
+            if (timeDifference(now, member->idleSince) >= idleTimeout_) {
+                LOG_INFO("UpstreamPool [%s] - closing idle %s\n", name_.c_str(), member->conn->name().c_str());
+                closeMember(member.get());
+            } else if (healthCheck_ && !healthCheck_(member->conn)) {
+                LOG_WARN("UpstreamPool [%s] - health check failed on %s\n", name_.c_str(), member->conn->name().c_str());
+                closeMember(member.get());
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "EventLoop.h"
+
+/**
+ * 与EventLoop配合的通用等待体：
+ *   co_await sleepFor(loop, seconds);           定时器到期后在loop线程恢复
+ *   auto v = co_await offload(pool, loop, f);   f在线程池中执行，结果就绪后回到loop线程恢复
+ * pool只需提供Post(std::function<void()>)，如ThreadPool。
+ **/
+class SleepAwaiter {
+public:
+    SleepAwaiter(EventLoop* loop, double seconds) : loop_(loop), seconds_(seconds) {}
+    bool await_ready() const noexcept { return seconds_ <= 0; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        loop_->runAfter(seconds_, [handle]() { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+
+private:
+    EventLoop* loop_;
+    double seconds_;
+};
+
+inline SleepAwaiter sleepFor(EventLoop* loop, double seconds) {
+    return SleepAwaiter(loop, seconds);
+}
+
+template <typename Pool, typename F>
+class OffloadAwaiter {
+public:
+    using Result = std::invoke_result_t<F>;
+
+    OffloadAwaiter(Pool& pool, EventLoop* loop, F func) : pool_(pool), loop_(loop), func_(std::move(func)) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        // 等待体位于挂起的协程帧中，恢复前地址不变，工作线程可直接写入结果
+        pool_.Post([this, handle]() {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    func_();
+                } else {
+                    result_.emplace(func_());
+                }
+            } catch (...) {
+                exception_ = std::current_exception();
+            }
+            loop_->queueInLoop([handle]() { handle.resume(); });
+        });
+    }
+    Result await_resume() {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*result_);
+        }
+    }
+
+private:
+    struct Empty {};
+    Pool& pool_;
+    EventLoop* loop_;
+    F func_;
+    std::conditional_t<std::is_void_v<Result>, Empty, std::optional<Result>> result_;
+    std::exception_ptr exception_;
+};
+
+template <typename Pool, typename F>
+OffloadAwaiter<Pool, F> offload(Pool& pool, EventLoop* loop, F func) {
+    return OffloadAwaiter<Pool, F>(pool, loop, std::move(func));
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "Buffer.h"
+#include "EventLoop.h"
+#include "TcpConnection.h"
+
+/**
+ * TcpConnection的协程视图：co_await read(n) / readUntil(delim) / write(data)。
+ * 在ConnectionCallback中（连接建立时、loop线程）调用attach，它接管该连接的消息/发送完成/连接回调；
+ * 之后所有操作都必须在该连接所属loop的协程中进行。读到的数据先累积在TcpConnection的输入缓冲区，满足条件时才恢复协程，
+ * 因此协议解析不需要手写状态机和堆上的上下文对象。连接关闭后所有读操作返回std::nullopt，write返回false。
+ **/
+class CoConnection : public std::enable_shared_from_this<CoConnection> {
+public:
+    using Ptr = std::shared_ptr<CoConnection>;
+
+    static Ptr attach(const TcpConnectionPtr& conn) {
+        Ptr self(new CoConnection(conn));
+        std::weak_ptr<CoConnection> weak(self);
+        conn->setMessageCallback([weak](const TcpConnectionPtr&, Buffer* buf, TimeStamp) {
+            if (Ptr self = weak.lock()) {  // 恢复的协程可能释放最后一个引用，处理期间保持存活
+                self->buffer_ = buf;
+                self->tryResumeReader();
+            }
+        });
+        conn->setWriteCompleteCallback([weak](const TcpConnectionPtr& conn) {
+            // 发送完成回调是排队执行的，可能属于更早的发送（如挂起前直接send的数据）；发送队列排空才说明本次写的数据已全部交给内核
+            if (conn->isSending()) {
+                return;
+            }
+            if (Ptr self = weak.lock()) {
+                self->resumeWriter(true);
+            }
+        });
+        conn->setConnectionCallback([weak](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                return;
+            }
+            if (Ptr self = weak.lock()) {
+                self->closed_ = true;
+                self->tryResumeReader();
+                self->resumeWriter(false);
+            }
+        });
+        return self;
+    }
+
+    const TcpConnectionPtr& connection() const { return conn_; }
+    bool closed() const { return closed_; }
+
+    class ReadAwaiter {
+    public:
+        bool await_ready() { return owner_->readable(*this); }
+        void await_suspend(std::coroutine_handle<> handle) {
+            owner_->reader_ = this;
+            handle_ = handle;
+        }
+        std::optional<std::string> await_resume() { return owner_->take(*this); }
+
+    private:
+        friend class CoConnection;
+        ReadAwaiter(CoConnection* owner, size_t length, std::string delimiter) : owner_(owner), length_(length), delimiter_(std::move(delimiter)) {}
+
+        CoConnection* owner_;
+        size_t length_;  // read(n)：需要的字节数
+        std::string delimiter_;  // readUntil：分隔符，非空时生效
+        bool satisfied_ = false;  // 缓冲区中的数据已满足条件
+        size_t end_ = 0;  // 满足条件时结果的长度
+        std::coroutine_handle<> handle_;
+    };
+
+    class WriteAwaiter {
+    public:
+        bool await_ready() { return owner_->closed_ || !owner_->conn_->connected(); }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            owner_->conn_->send(data_);
+            if (!owner_->conn_->isSending()) {  // 已直接全部写出，不挂起；对应的发送完成回调到达时没有挂起的写，忽略
+                owner_->writeOk_ = owner_->conn_->connected();
+                return false;
+            }
+            owner_->writer_ = handle;
+            return true;
+        }
+        bool await_resume() { return !owner_->closed_ && owner_->writeOk_; }
+
+    private:
+        friend class CoConnection;
+        WriteAwaiter(CoConnection* owner, std::string data) : owner_(owner), data_(std::move(data)) {}
+
+        CoConnection* owner_;
+        std::string data_;
+    };
+
+    // 读取恰好n个字节
+    ReadAwaiter read(size_t n) { return ReadAwaiter(this, n, std::string()); }
+    // 读取到delim为止（结果包含delim）
+    ReadAwaiter readUntil(std::string delim) { return ReadAwaiter(this, 0, std::move(delim)); }
+    // 发送数据，全部交给内核后恢复
+    WriteAwaiter write(std::string data) { return WriteAwaiter(this, std::move(data)); }
+
+    void shutdown() { conn_->shutdown(); }
+
+private:
+    explicit CoConnection(const TcpConnectionPtr& conn) : conn_(conn), buffer_(nullptr), closed_(false), reader_(nullptr), writeOk_(false) {}
+
+    bool readable(ReadAwaiter& awaiter) {
+        if (awaiter.delimiter_.empty() && awaiter.length_ == 0) {
+            awaiter.satisfied_ = true;
+            return true;
+        }
+        if (buffer_ == nullptr) {
+            return closed_;
+        }
+        const char* begin = buffer_->peek();
+        const char* end = begin + buffer_->readableBytes();
+        if (awaiter.delimiter_.empty()) {
+            if (buffer_->readableBytes() >= awaiter.length_) {
+                awaiter.satisfied_ = true;
+                awaiter.end_ = awaiter.length_;
+                return true;
+            }
+        } else {
+            const char* found = std::search(begin, end, awaiter.delimiter_.begin(), awaiter.delimiter_.end());
+            if (found != end) {
+                awaiter.satisfied_ = true;
+                awaiter.end_ = found - begin + awaiter.delimiter_.size();
+                return true;
+            }
+        }
+        return closed_;  // 已关闭时不再等待，由take返回nullopt
+    }
+
+    std::optional<std::string> take(ReadAwaiter& awaiter) {
+        if (!awaiter.satisfied_) {
+            return std::nullopt;  // 连接已关闭且数据不足
+        }
+        if (awaiter.end_ == 0) {
+            return std::string();
+        }
+        return buffer_->retrieveAsString(awaiter.end_);
+    }
+
+    void tryResumeReader() {
+        if (reader_ != nullptr && readable(*reader_)) {
+            ReadAwaiter* reader = reader_;
+            reader_ = nullptr;
+            reader->handle_.resume();
+        }
+    }
+
+    void resumeWriter(bool ok) {
+        if (writer_) {
+            writeOk_ = ok;
+            std::coroutine_handle<> writer = writer_;
+            writer_ = nullptr;
+            writer.resume();
+        }
+    }
+
+    TcpConnectionPtr conn_;
+    Buffer* buffer_;  // 即TcpConnection的输入缓冲区，第一次收到数据时记下
+    bool closed_;
+    ReadAwaiter* reader_;  // 挂起中的读操作
+    std::coroutine_handle<> writer_;  // 挂起中的写操作
+    bool writeOk_;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "NonCopyable.h"
+
+/**
+ * 协程帧分配器：按64字节分级缓存释放的帧，同一线程（即同一loop）内反复创建协程不再调用malloc。
+ * 每个线程一个实例；协程总是在所属loop线程中创建和销毁，因此无需加锁。
+ * 超过kMaxPooledSize的帧直接走operator new。
+ **/
+class FramePool : NonCopyable {
+public:
+    static const size_t kGranularity = 64;
+    static const size_t kMaxPooledSize = 2048;
+    static const size_t kMaxCachedPerClass = 1024;  // 每个尺寸最多缓存的帧数，限制空闲内存
+
+    static FramePool& instance() {
+        static thread_local FramePool pool;
+        return pool;
+    }
+
+    void* allocate(size_t size) {
+        size_t total = size + kHeaderSize;
+        size_t index = (total + kGranularity - 1) / kGranularity;
+        if (index >= kNumClasses) {
+            Header* header = static_cast<Header*>(::operator new(total));
+            header->sizeClass = 0;
+            return header + 1;
+        }
+        std::vector<void*>& freeList = freeLists_[index];
+        Header* header;
+        if (!freeList.empty()) {
+            header = static_cast<Header*>(freeList.back());
+            freeList.pop_back();
+            ++hits_;
+        } else {
+            header = static_cast<Header*>(::operator new(index * kGranularity));
+            ++misses_;
+        }
+        header->sizeClass = index;
+        return header + 1;
+    }
+
+    void deallocate(void* ptr) {
+        Header* header = static_cast<Header*>(ptr) - 1;
+        size_t index = header->sizeClass;
+        if (index == 0 || freeLists_[index].size() >= kMaxCachedPerClass) {
+            ::operator delete(header);
+            return;
+        }
+        freeLists_[index].push_back(header);
+    }
+
+    size_t hits() const { return hits_; }  // 从缓存中取到帧的次数
+    size_t misses() const { return misses_; }  // 需要新分配的次数
+
+    ~FramePool() {
+        for (std::vector<void*>& freeList : freeLists_) {
+            for (void* block : freeList) {
+                ::operator delete(block);
+            }
+        }
+    }
+
+private:
+    FramePool() : freeLists_(kNumClasses), hits_(0), misses_(0) {}
+
+    // 帧前的头部记录尺寸等级，释放时据此归还，0表示未走缓存
+    struct alignas(std::max_align_t) Header {
+        size_t sizeClass;
+    };
+    static const size_t kHeaderSize = sizeof(Header);
+    static const size_t kNumClasses = kMaxPooledSize / kGranularity + 1;
+
+    std::vector<std::vector<void*>> freeLists_;
+    size_t hits_;
+    size_t misses_;
+};
+
+// promise_type继承该类即可让协程帧从FramePool分配
+struct PooledFrame {
+    static void* operator new(size_t size) { return FramePool::instance().allocate(size); }
+    static void operator delete(void* ptr) { FramePool::instance().deallocate(ptr); }
+};
@@ -53,32 +53,34 @@ public:
     }
 
     ssize_t Recv(int fd, int* err) {
-        char extra_buf[65536];  // 64KB
+        // 线程局部暂存区，避免每次调用在栈上占用64KB；内容随即被拷走，无需清零
+        static thread_local char extra_buf[65536];  // 64KB
         /**
          *struct iovec {
          *    ptr_t iov_base; // iov_base指向的缓冲区存放的是readv所接收的数据或是writev将要发送的数据
          *    size_t iov_len; // iov_len在各种情况下分别确定了接收的最大长度以及实际写入的长度
          *};
          */
+        const std::size_t free_size = GetFreeSize();
         struct iovec vec[2];
         vec[0].iov_base = GetWritePointer();
-        vec[0].iov_len = GetFreeSize();
+        vec[0].iov_len = free_size;
         vec[1].iov_base = extra_buf;
         vec[1].iov_len = sizeof(extra_buf);
 
-        std::size_t n = readv(fd, vec, 2);
+        ssize_t n = readv(fd, vec, 2);
         if (n < 0) {
             *err = errno;
             return n;
         } else if (n == 0) {
             *err = EBADE;
             return 0;
-        } else if (n <= GetFreeSize()) {
+        } else if (static_cast<std::size_t>(n) <= free_size) {
             WriteCompleted(n);
             return n;
         } else {
-            WriteCompleted(GetFreeSize());
-            std::size_t extra_size = n - GetFreeSize();
+            WriteCompleted(free_size);
+            std::size_t extra_size = n - free_size;
             Write(reinterpret_cast<uint8_t*>(extra_buf), extra_size);
             return n;
         }
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+
+// 侵入式队列的链接字段，入队元素需继承它
+struct MpscNode {
+    std::atomic<MpscNode*> mpscNext{nullptr};
+};
+
+// 无锁多生产者单消费者队列（Vyukov intrusive MPSC）
+// 链接字段嵌在元素自身（T需继承MpscNode），入队出队都不分配内存；队列不拥有元素，由调用方负责其生命周期。
+// Push 可在任意线程并发调用，只需一次原子交换；Pop 只能由唯一的消费者线程调用。
+// 一个元素同一时刻只能在一个队列中。
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(T* node) { push(node); }
+
+    // 队列为空，或生产者尚未完成链接（稍后重试即可）时返回nullptr
+    T* Pop() {
+        MpscNode* tail = tail_;
+        MpscNode* next = tail->mpscNext.load(std::memory_order_acquire);
+        if (tail == &stub_) {  // 跳过哑节点
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->mpscNext.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            return nullptr;  // 有生产者已抢占head但还没链接到tail之后
+        }
+        // tail是最后一个元素：重新放入哑节点，tail才能安全出队
+        push(&stub_);
+        next = tail->mpscNext.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        return nullptr;
+    }
+
+    // 仅用于估计，消费者线程调用才准确
+    bool Empty() const { return tail_ == &stub_ && stub_.mpscNext.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    void push(MpscNode* node) {
+        node->mpscNext.store(nullptr, std::memory_order_relaxed);
+        // 先抢占head，再把前驱链接到新节点；两步之间消费者可能暂时看不到后续节点，但不会丢失
+        MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->mpscNext.store(node, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<MpscNode*> head_;  // 生产者竞争的入队端
+    alignas(64) MpscNode* tail_;  // 消费者独占的出队端
+    MpscNode stub_;  // 哑节点，队列取空时重新入队
+};
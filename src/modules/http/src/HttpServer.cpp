@@ -50,7 +50,7 @@ void HttpServer::onRequest(const TcpConnectionPtr& conn, HttpRequest& req) {
     }
     Buffer buf;
     response.appendToBuffer(&buf);
-    conn->send(buf.retrieveAllAsString());
+    conn->send(&buf);  // 直接从buf写出，不再先拷贝成string
     if (response.closeConnection()) {
         conn->shutdown();
     }
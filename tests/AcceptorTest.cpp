@@ -0,0 +1,179 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Acceptor.h"
+#include "EventLoop.h"
+#include "InetAddress.h"
+#include "Logger.h"
+
+namespace {
+int connectTo(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int ret = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr);
+    assert(ret == 0);
+    return fd;
+}
+}  // namespace
+
+// 一次可读事件把积压的连接全部accept，作为一批交给上层
+void TestBatchAccept() {
+    const uint16_t port = 19529;
+    const int kClients = 20;
+    EventLoop loop;
+    Acceptor acceptor(&loop, InetAddress("127.0.0.1", port), true);
+    std::vector<size_t> batches;
+    acceptor.setNewConnectionBatchCallback([&](const std::vector<Acceptor::AcceptedSocket>& batch) {
+        batches.push_back(batch.size());
+        for (const Acceptor::AcceptedSocket& accepted : batch) {
+            ::close(accepted.sockfd);
+        }
+    });
+    acceptor.listen();
+
+    // 三次握手由内核完成，连接在backlog中排队
+    std::vector<int> fds;
+    for (int i = 0; i < kClients; ++i) {
+        fds.push_back(connectTo(port));
+    }
+    loop.runAfter(0.05, [&loop]() { loop.quit(); });
+    loop.loop();
+    assert(batches.size() == 1 && batches[0] == static_cast<size_t>(kClients));
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    std::cout << "TestBatchAccept passed!" << std::endl;
+}
+
+// fd耗尽时借用预留fd接受并关闭连接：对端收到FIN，监听fd不会一直可读导致loop空转
+void TestShedOnEmfile() {
+    const uint16_t port = 19530;
+    EventLoop loop;
+    Acceptor acceptor(&loop, InetAddress("127.0.0.1", port), true);
+    int accepted = 0;
+    acceptor.setNewConnectionCallback([&](int sockfd, const InetAddress&) {
+        ++accepted;
+        ::close(sockfd);
+    });
+    acceptor.listen();
+    int client = connectTo(port);
+
+    // 把fd上限压到当前最小空闲fd，新的accept只能返回EMFILE
+    rlimit saved;
+    ::getrlimit(RLIMIT_NOFILE, &saved);
+    int probe = ::dup(0);
+    ::close(probe);
+    rlimit limited = saved;
+    limited.rlim_cur = probe;
+    assert(::setrlimit(RLIMIT_NOFILE, &limited) == 0);
+
+    loop.runAfter(0.05, [&loop]() { loop.quit(); });
+    loop.loop();
+    ::setrlimit(RLIMIT_NOFILE, &saved);
+
+    assert(accepted == 0);
+    char buf[16];
+    assert(::read(client, buf, sizeof buf) == 0);  // 连接被服务端关闭
+    EventLoopMetrics::Snapshot metrics = loop.metricsSnapshot();
+    assert(metrics.events < 10);  // 监听fd没有反复就绪
+    ::close(client);
+    std::cout << "TestShedOnEmfile passed!" << std::endl;
+}
+
+// ET模式下积压超过单次上限时排队续接；续接执行前Acceptor已被销毁，任务不能再访问它
+void TestDestroyWithPendingContinuation() {
+    const uint16_t port = 19547;
+    const int kClients = 300;  // 超过kMaxAcceptsPerEvent
+    EventLoop loop;
+    std::unique_ptr<Acceptor> acceptor(new Acceptor(&loop, InetAddress("127.0.0.1", port), true));
+    acceptor->setEdgeTriggered(true);
+    int batches = 0;
+    acceptor->setNewConnectionBatchCallback([&](const std::vector<Acceptor::AcceptedSocket>& batch) {
+        ++batches;
+        for (const Acceptor::AcceptedSocket& accepted : batch) {
+            ::close(accepted.sockfd);
+        }
+        // 先于续接任务入队，同一轮中先执行
+        loop.queueInLoop([&acceptor]() { acceptor.reset(); });
+    });
+    acceptor->listen();
+
+    std::vector<int> fds;
+    for (int i = 0; i < kClients; ++i) {
+        fds.push_back(connectTo(port));
+    }
+    loop.runAfter(0.05, [&loop]() { loop.quit(); });
+    loop.loop();
+    assert(!acceptor);
+    assert(batches == 1);
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    std::cout << "TestDestroyWithPendingContinuation passed!" << std::endl;
+}
+
+// fd耗尽且预留fd也没能打开：暂停监听并定时重试，不空转；fd恢复后重新打开预留fd，积压的连接被接受
+void TestBackoffWithoutReserve(bool edgeTriggered) {
+    const uint16_t port = edgeTriggered ? 19549 : 19548;
+    EventLoop loop;
+    int client = ::socket(AF_INET, SOCK_STREAM, 0);  // 在压低fd上限之前创建
+
+    // 上限只容得下监听socket，Acceptor构造时预留fd打开失败
+    rlimit saved;
+    ::getrlimit(RLIMIT_NOFILE, &saved);
+    int probe = ::dup(0);
+    ::close(probe);
+    rlimit limited = saved;
+    limited.rlim_cur = probe + 1;
+    assert(::setrlimit(RLIMIT_NOFILE, &limited) == 0);
+
+    Acceptor acceptor(&loop, InetAddress("127.0.0.1", port), true);
+    acceptor.setEdgeTriggered(edgeTriggered);
+    int accepted = 0;
+    acceptor.setNewConnectionCallback([&](int sockfd, const InetAddress&) {
+        ++accepted;
+        ::close(sockfd);
+    });
+    acceptor.listen();
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    assert(::connect(client, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0);
+
+    uint64_t iterations = 0;
+    loop.runAfter(0.35, [&]() {
+        iterations = loop.metricsSnapshot().iterations;
+        assert(accepted == 0);
+        ::setrlimit(RLIMIT_NOFILE, &saved);
+    });
+    loop.runAfter(0.6, [&loop]() { loop.quit(); });
+    loop.loop();
+    assert(iterations < 50);  // 约每100ms重试一次，而不是每轮都重新accept
+    assert(accepted == 1);
+    ::close(client);
+    std::cout << "TestBackoffWithoutReserve(edgeTriggered=" << edgeTriggered << ") passed!" << std::endl;
+}
+
+int main() {
+    Logger::instance().setLogLevel(FATAL);
+    TestBatchAccept();
+    TestShedOnEmfile();
+    TestDestroyWithPendingContinuation();
+    TestBackoffWithoutReserve(false);
+    TestBackoffWithoutReserve(true);
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "Buffer.h"
+#include "SlabPool.h"
+
+namespace {
+std::string pattern(size_t len, char seed) {
+    std::string s(len, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        s[i] = static_cast<char>(seed + i % 23);
+    }
+    return s;
+}
+
+ssize_t readOnce(Buffer& buf, const std::string& msg, char* scratch = nullptr, size_t scratchLen = 0) {
+    int fds[2];
+    assert(::pipe(fds) == 0);
+    assert(::write(fds[1], msg.data(), msg.size()) == static_cast<ssize_t>(msg.size()));
+    int saveErrno = 0;
+    ssize_t n = buf.readFd(fds[0], &saveErrno, SIZE_MAX, scratch, scratchLen);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return n;
+}
+}  // namespace
+
+// 超出可写空间的部分经暂存区追加，数据完整
+void TestReadThroughScratch() {
+    char scratch[16 * 1024];
+    Buffer buf;
+    std::string msg = pattern(12 * 1024, 'a');
+    assert(readOnce(buf, msg, scratch, sizeof scratch) == static_cast<ssize_t>(msg.size()));
+    assert(buf.retrieveAllAsString() == msg);
+    std::cout << "TestReadThroughScratch passed!" << std::endl;
+}
+
+// 连续读到大消息时预读大小翻倍直到消息能直接落进Buffer，连续小读后减半并归还多余空间
+void TestAdaptiveReadHint() {
+    Buffer buf;
+    assert(buf.readHint() == Buffer::kInitialSize);
+    std::string big = pattern(8 * 1024, 'A');
+    for (int i = 0; i < 16; ++i) {
+        assert(readOnce(buf, big) == static_cast<ssize_t>(big.size()));
+        assert(buf.retrieveAllAsString() == big);
+    }
+    assert(buf.readHint() >= big.size());
+    assert(buf.readHint() <= Buffer::kMaxReadHint);
+
+    size_t grown = buf.readHint();
+    std::string small = "ping";
+    for (int i = 0; i < 64; ++i) {
+        assert(readOnce(buf, small) == 4);
+        assert(buf.retrieveAllAsString() == small);
+    }
+    assert(buf.readHint() < grown);
+    assert(buf.readHint() == Buffer::kInitialSize);
+    // 空闲时按预读大小重新分配，可写空间回到预读大小附近
+    readOnce(buf, small);
+    buf.retrieveAll();
+    assert(buf.writableBytes() <= 4 * Buffer::kInitialSize);
+    std::cout << "TestAdaptiveReadHint passed!" << std::endl;
+}
+
+// maxBytes限制在预留空间和暂存区上同样生效
+void TestReadBudget() {
+    Buffer buf;
+    std::string msg = pattern(4096, '0');
+    int fds[2];
+    assert(::pipe(fds) == 0);
+    assert(::write(fds[1], msg.data(), msg.size()) == static_cast<ssize_t>(msg.size()));
+    int saveErrno = 0;
+    assert(buf.readFd(fds[0], &saveErrno, 1000) == 1000);
+    assert(buf.readFd(fds[0], &saveErrno, 5000) == 3096);
+    assert(buf.retrieveAllAsString() == msg);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    std::cout << "TestReadBudget passed!" << std::endl;
+}
+
+// 池化的Buffer按需从SlabPool分配，读完归还，残留数据时收缩到最小级别
+void TestPooledStorage() {
+    SlabPool pool;
+    Buffer buf(&pool);
+    assert(buf.capacity() == 0);
+    assert(buf.readableBytes() == 0);
+    std::string msg = pattern(3000, 'x');
+    assert(readOnce(buf, msg) == static_cast<ssize_t>(msg.size()));
+    assert(buf.capacity() == SlabPool::roundUp(buf.capacity()));  // 按级别分配
+    assert(pool.bytesInUse() == buf.capacity());
+
+    buf.retrieve(2990);
+    buf.shrinkToFit();
+    assert(buf.capacity() == SlabPool::kMinClassSize);
+    assert(buf.retrieveAllAsString() == msg.substr(2990));
+    buf.releaseStorage();
+    assert(buf.capacity() == 0);
+    assert(pool.bytesInUse() == 0);
+    assert(pool.bytesCached() > 0);
+
+    // 再次读取复用池中的存储
+    uint64_t allocations = pool.heapAllocations();
+    assert(readOnce(buf, "hello") == 5);
+    assert(pool.heapAllocations() == allocations);
+
+    // 移动/交换连同所属的池一起转移
+    Buffer other;
+    other.swap(buf);
+    assert(other.retrieveAllAsString() == "hello");
+    other.releaseStorage();
+    assert(pool.bytesInUse() == 0);
+    Buffer copy(other);
+    assert(copy.readableBytes() == 0);
+    std::cout << "TestPooledStorage passed!" << std::endl;
+}
+
+int main() {
+    TestReadThroughScratch();
+    TestAdaptiveReadHint();
+    TestReadBudget();
+    TestPooledStorage();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "Buffer.h"
+#include "ChainBuffer.h"
+#include "SlabPool.h"
+
+namespace {
+std::string pattern(size_t len, char seed) {
+    std::string s(len, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        s[i] = static_cast<char>(seed + i % 29);
+    }
+    return s;
+}
+}  // namespace
+
+// 追加跨越多个slab，已有数据不搬移；读完的slab归还池
+void TestAppendAndRetrieve() {
+    SlabPool pool;
+    ChainBuffer buf(&pool);
+    std::string data = pattern(3 * ChainBuffer::kSlabSize + 100, 'a');
+    buf.append(data.data(), 1000);
+    buf.append(data.data() + 1000, data.size() - 1000);
+    assert(buf.readableBytes() == data.size());
+    assert(buf.slabCount() == 4);
+
+    buf.retrieve(ChainBuffer::kSlabSize + 10);
+    assert(buf.slabCount() == 3);
+    assert(pool.bytesCached() == ChainBuffer::kSlabSize);
+    assert(pool.bytesInUse() == 3 * ChainBuffer::kSlabSize);
+    assert(buf.retrieveAllAsString() == data.substr(ChainBuffer::kSlabSize + 10));
+    assert(buf.readableBytes() == 0);
+    assert(buf.slabCount() == 0);  // 空缓冲区不占用slab
+    assert(pool.bytesCached() == 4 * ChainBuffer::kSlabSize);
+    assert(pool.bytesInUse() == 0);
+
+    // 再次使用时复用池中的slab，不再向堆申请
+    uint64_t allocations = pool.heapAllocations();
+    buf.append(data.data(), data.size());
+    assert(pool.heapAllocations() == allocations);
+    std::cout << "TestAppendAndRetrieve passed!" << std::endl;
+}
+
+// prepend先用头部已读出的空间，不够时在链头挂新slab
+void TestPrepend() {
+    SlabPool pool;
+    ChainBuffer buf(&pool);
+    buf.append("0123456789body", 14);
+    buf.retrieve(10);
+    buf.prepend("head:", 5);
+    assert(buf.slabCount() == 1);
+    std::string big = pattern(ChainBuffer::kSlabSize + 7, 'A');
+    buf.prepend(big.data(), big.size());
+    assert(buf.slabCount() == 3);
+    assert(buf.retrieveAllAsString() == big + "head:body");
+    std::cout << "TestPrepend passed!" << std::endl;
+}
+
+// 多个slab一次writev写出，部分写后剩余数据保持顺序
+void TestWritev() {
+    int fds[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    int sndbuf = 64 * 1024;
+    ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof sndbuf);
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+    ChainBuffer buf;
+    std::string data;
+    for (int i = 0; i < 200; ++i) {  // 模拟流水线上的大量小响应
+        std::string resp = "HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n" + pattern(1000, static_cast<char>('a' + i % 20));
+        buf.append(resp.data(), resp.size());
+        data += resp;
+    }
+    std::string received;
+    char readBuf[65536];
+    while (buf.readableBytes() > 0) {
+        int saveErrno = 0;
+        ssize_t n = buf.writeFd(fds[0], &saveErrno);
+        if (n > 0) {
+            buf.retrieve(n);
+        } else {
+            assert(saveErrno == EAGAIN);
+        }
+        ssize_t r = ::read(fds[1], readBuf, sizeof readBuf);
+        assert(r > 0);
+        received.append(readBuf, r);
+    }
+    ::shutdown(fds[0], SHUT_WR);
+    ssize_t r;
+    while ((r = ::read(fds[1], readBuf, sizeof readBuf)) > 0) {
+        received.append(readBuf, r);
+    }
+    assert(received == data);
+
+    // maxBytes限制单次写出量
+    buf.append(data.data(), 5000);
+    int fds2[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds2) == 0);
+    int saveErrno = 0;
+    assert(buf.writeFd(fds2[0], &saveErrno, 1234) == 1234);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    ::close(fds2[0]);
+    ::close(fds2[1]);
+    std::cout << "TestWritev passed!" << std::endl;
+}
+
+// 共享数据片只挂引用：与普通数据交错追加，顺序正确，发送完毕后引用释放
+void TestSharedSlices() {
+    SlabPool pool;
+    ChainBuffer buf(&pool);
+    SharedSlice payload(pattern(3 * ChainBuffer::kSlabSize, 'p'));
+    buf.append("header:", 7);
+    buf.appendShared(payload.slice(5));
+    buf.append(":trailer", 8);  // 不会写进共享段
+    buf.prepend("<", 1);
+    assert(payload.useCount() == 2);
+    assert(buf.slabCount() == 4);
+    assert(pool.bytesInUse() == 3 * ChainBuffer::kSlabSize);  // 共享段不占池内存
+
+    int fds[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    std::string expected = "<header:" + std::string(payload.data() + 5, payload.size() - 5) + ":trailer";
+    std::string received;
+    char readBuf[65536];
+    while (buf.readableBytes() > 0) {
+        int saveErrno = 0;
+        ssize_t n = buf.writeFd(fds[0], &saveErrno);
+        assert(n > 0);
+        buf.retrieve(n);
+        while (received.size() < expected.size() - buf.readableBytes()) {
+            ssize_t r = ::read(fds[1], readBuf, sizeof readBuf);
+            assert(r > 0);
+            received.append(readBuf, r);
+        }
+    }
+    assert(received == expected);
+    assert(payload.useCount() == 1);
+    assert(pool.bytesInUse() == 0);
+
+    // 未发送就丢弃时同样释放引用
+    buf.appendShared(payload);
+    assert(payload.useCount() == 2);
+    buf.retrieveAll();
+    assert(payload.useCount() == 1);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    std::cout << "TestSharedSlices passed!" << std::endl;
+}
+
+// 析构时残留的存储归还池，统计回到0；在其他线程析构时直接释放，同样扣减统计
+void TestDestroyReturnsStorage() {
+    SlabPool pool;
+    std::string data = pattern(3 * ChainBuffer::kSlabSize, 'd');
+    {
+        ChainBuffer chain(&pool);
+        Buffer input(&pool);
+        chain.append(data.data(), data.size());
+        input.append(data.data(), 4096);
+        assert(pool.bytesInUse() > 0);
+    }
+    assert(pool.bytesInUse() == 0);
+    size_t cached = pool.bytesCached();
+    assert(cached >= 3 * ChainBuffer::kSlabSize);  // 所属线程中析构，放回空闲链表
+
+    std::unique_ptr<ChainBuffer> chain(new ChainBuffer(&pool));
+    std::unique_ptr<Buffer> input(new Buffer(&pool));
+    chain->append(data.data(), data.size());
+    input->append(data.data(), 4096);
+    assert(pool.bytesInUse() > 0);
+    std::thread([&chain, &input]() {
+        chain.reset();
+        input.reset();
+    }).join();
+    assert(pool.bytesInUse() == 0);
+    assert(pool.bytesCached() <= cached);  // 其他线程不访问空闲链表
+    std::cout << "TestDestroyReturnsStorage passed!" << std::endl;
+}
+
+int main() {
+    TestAppendAndRetrieve();
+    TestPrepend();
+    TestWritev();
+    TestSharedSlices();
+    TestDestroyReturnsStorage();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "CoAwaitables.h"
+#include "CoConnection.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "Task.h"
+#include "TcpServer.h"
+#include "TestUtil.h"
+#include "ThreadPool/ThreadPool.h"
+
+namespace {
+Task<int> delayedValue(EventLoop* loop, int value) {
+    co_await sleepFor(loop, 0.01);
+    co_return value;
+}
+
+Task<int> sum(EventLoop* loop, int n) {
+    int total = 0;
+    for (int i = 1; i <= n; ++i) {
+        total += co_await delayedValue(loop, i);
+    }
+    co_return total;
+}
+
+Task<void> throwing() {
+    throw std::runtime_error("boom");
+    co_return;
+}
+}  // namespace
+
+// 嵌套任务、定时器等待与异常传播
+void TestTaskAndSleep() {
+    EventLoop loop;
+    int result = 0;
+    bool caught = false;
+    coSpawn(&loop, [](EventLoop* loop, int* result, bool* caught) -> Task<void> {
+        *result = co_await sum(loop, 4);
+        try {
+            co_await throwing();
+        } catch (const std::runtime_error&) {
+            *caught = true;
+        }
+        loop->quit();
+    }(&loop, &result, &caught));
+    loop.loop();
+    assert(result == 10);
+    assert(caught);
+    std::cout << "TestTaskAndSleep passed!" << std::endl;
+}
+
+// 线程池执行的结果回到原loop线程恢复
+void TestOffload() {
+    EventLoop loop;
+    ThreadPool pool(2);
+    bool done = false;
+    coSpawn(&loop, [](EventLoop* loop, ThreadPool* pool, bool* done) -> Task<void> {
+        std::thread::id loopThread = std::this_thread::get_id();
+        std::thread::id worker = co_await offload(*pool, loop, []() { return std::this_thread::get_id(); });
+        assert(worker != loopThread);
+        assert(std::this_thread::get_id() == loopThread);
+        bool threw = false;
+        try {
+            co_await offload(*pool, loop, []() -> int { throw std::runtime_error("worker failed"); });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        *done = true;
+        loop->quit();
+    }(&loop, &pool, &done));
+    loop.loop();
+    assert(done);
+    std::cout << "TestOffload passed!" << std::endl;
+}
+
+// 重复创建同尺寸的协程帧应复用缓存
+void TestFramePool() {
+    EventLoop loop;
+    size_t hitsBefore = FramePool::instance().hits();
+    coSpawn(&loop, [](EventLoop* loop) -> Task<void> {
+        for (int i = 0; i < 100; ++i) {
+            co_await delayedValue(loop, i);  // sleepFor(0.01)
+        }
+        loop->quit();
+    }(&loop));
+    loop.loop();
+    assert(FramePool::instance().hits() - hitsBefore >= 99);
+    std::cout << "TestFramePool passed!" << std::endl;
+}
+
+namespace {
+// 简单的长度前缀协议："LEN n\r\n" + n字节正文，原样回显正文
+Task<void> serveLengthPrefixed(CoConnection::Ptr conn) {
+    while (true) {
+        std::optional<std::string> header = co_await conn->readUntil("\r\n");
+        if (!header) {
+            co_return;  // 对端关闭
+        }
+        size_t length = std::stoul(header->substr(4));
+        std::optional<std::string> body = co_await conn->read(length);
+        if (!body || !co_await conn->write(*body)) {
+            co_return;
+        }
+    }
+}
+
+std::string readExactly(int fd, size_t n) {
+    std::string data;
+    char buf[256];
+    while (data.size() < n) {
+        ssize_t got = ::read(fd, buf, std::min(sizeof buf, n - data.size()));
+        assert(got > 0);
+        data.append(buf, got);
+    }
+    return data;
+}
+}  // namespace
+
+// 协程式的协议处理：数据分多次到达时协程在缓冲区满足条件后才恢复
+void TestCoConnection() {
+    const uint16_t port = 19532;
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "CoServer");
+        tcpServer.setThreadNum(1);
+        tcpServer.setConnectionCallback([](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                coSpawn(conn->getLoop(), serveLengthPrefixed(CoConnection::attach(conn)));
+            }
+        });
+        tcpServer.start();
+        run(&loop);
+    });
+
+    int fd = connectTo(port);
+
+    const char* pieces[] = {"LE", "N 5\r", "\nhel", "lo", "LEN 3\r\nabcLEN 2\r\nxy"};
+    for (const char* piece : pieces) {
+        assert(::write(fd, piece, strlen(piece)) == static_cast<ssize_t>(strlen(piece)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));  // 让各片分别到达，协程要跨多次读事件拼出消息
+    }
+    assert(readExactly(fd, 10) == "helloabcxy");
+    ::close(fd);
+
+    server.stop();
+    std::cout << "TestCoConnection passed!" << std::endl;
+}
+
+// write只在自己的数据写出后恢复：挂起前直接send的数据排空时排队的发送完成回调不能提前恢复它
+void TestWriteWaitsForOwnData() {
+    const uint16_t port = 19553;
+    const size_t kPayload = 8 * 1024 * 1024;  // 远超socket缓冲区，客户端不读时一定挂起
+    std::atomic<bool> resumed(false);
+    std::atomic<bool> writeOk(false);
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "CoWriter");
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (!conn->connected()) {
+                return;
+            }
+            coSpawn(conn->getLoop(), [](CoConnection::Ptr conn, size_t payload, std::atomic<bool>* resumed, std::atomic<bool>* writeOk) -> Task<void> {
+                conn->connection()->send("x");  // 立即写出，发送完成回调已排队
+                *writeOk = co_await conn->write(std::string(payload, 'w'));
+                *resumed = true;
+            }(CoConnection::attach(conn), kPayload, &resumed, &writeOk));
+        });
+        tcpServer.start();
+        run(&loop);
+    });
+
+    int fd = connectTo(port);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // 观察窗口：排队的回调已执行，但数据还在发送队列中
+    assert(!resumed);
+    std::string received = readExactly(fd, kPayload + 1);
+    assert(received.size() == kPayload + 1);
+    assert(waitUntil([&]() { return resumed.load(); }));
+    assert(writeOk);
+
+    ::close(fd);
+    server.stop();
+    std::cout << "TestWriteWaitsForOwnData passed!" << std::endl;
+}
+
+int main() {
+    Logger::instance().setLogLevel(WARN);
+    TestTaskAndSleep();
+    TestOffload();
+    TestFramePool();
+    TestCoConnection();
+    TestWriteWaitsForOwnData();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
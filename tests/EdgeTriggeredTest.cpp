@@ -0,0 +1,103 @@
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "EventLoop.h"
+#include "Logger.h"
+#include "TcpServer.h"
+#include "TestUtil.h"
+
+// 回显大块数据：单次事件预算很小，验证每次上报的数据不超过预算、预算耗尽后能继续读写，且数据完整回显
+void TestEchoBulk(int numThreads, bool edgeTriggered) {
+    const size_t budget = 64 * 1024;
+    const uint16_t port = 19527;
+    const size_t total = 4 * 1024 * 1024;
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "EtEcho", TcpServer::kReusePort);
+        tcpServer.setEdgeTriggered(edgeTriggered);
+        tcpServer.setEventByteBudget(budget);
+        tcpServer.setThreadNum(numThreads);
+        tcpServer.setConnectionCallback([](const TcpConnectionPtr&) {});
+        tcpServer.setMessageCallback([budget](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) {
+            assert(buf->readableBytes() <= budget);
+            conn->send(buf->retrieveAllAsString());
+        });
+        tcpServer.start();
+        run(&loop);
+    });
+
+    int fd = connectTo(port);
+
+    std::string payload(total, '\0');
+    for (size_t i = 0; i < total; ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    std::thread writer([&]() {
+        size_t sent = 0;
+        while (sent < total) {
+            ssize_t n = ::write(fd, payload.data() + sent, total - sent);
+            assert(n > 0);
+            sent += n;
+        }
+    });
+    std::string echoed;
+    char buf[65536];
+    while (echoed.size() < total) {
+        ssize_t n = ::read(fd, buf, sizeof buf);
+        assert(n > 0);
+        echoed.append(buf, n);
+    }
+    writer.join();
+    assert(echoed == payload);
+    ::close(fd);
+
+    server.stop();
+    std::cout << "TestEchoBulk(" << numThreads << " threads, " << (edgeTriggered ? "ET" : "LT") << ") passed!" << std::endl;
+}
+
+// 预算为0表示不限制：连接能正常收发，而不是被当作对端关闭
+void TestUnlimitedBudget(bool edgeTriggered) {
+    const uint16_t port = 19527;
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "EtUnlimited", TcpServer::kReusePort);
+        tcpServer.setEdgeTriggered(edgeTriggered);
+        tcpServer.setEventByteBudget(0);
+        tcpServer.setConnectionCallback([](const TcpConnectionPtr&) {});
+        tcpServer.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) { conn->send(buf->retrieveAllAsString()); });
+        tcpServer.start();
+        run(&loop);
+    });
+
+    int fd = connectTo(port);
+    const std::string payload = "hello";
+    assert(::write(fd, payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+    std::string echoed;
+    char buf[64];
+    while (echoed.size() < payload.size()) {
+        ssize_t n = ::read(fd, buf, sizeof buf);
+        assert(n > 0);
+        echoed.append(buf, n);
+    }
+    assert(echoed == payload);
+    ::close(fd);
+
+    server.stop();
+    std::cout << "TestUnlimitedBudget(" << (edgeTriggered ? "ET" : "LT") << ") passed!" << std::endl;
+}
+
+int main() {
+    Logger::instance().setLogLevel(WARN);
+    TestEchoBulk(0, true);
+    TestEchoBulk(2, true);
+    TestEchoBulk(0, false);
+    TestEchoBulk(2, false);
+    TestUnlimitedBudget(true);
+    TestUnlimitedBudget(false);
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
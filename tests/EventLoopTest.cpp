@@ -0,0 +1,333 @@
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Channel.h"
+#include "EventLoop.h"
+#include "Logger.h"
+
+// 测试忙轮询：事件密集时自旋能直接取到事件，空闲时窗口收缩并进入阻塞等待
+void TestBusyPoll() {
+    EventLoop loop;
+    loop.setBusyPoll(5000);
+
+    // 每200微秒一次的定时器落在5ms自旋预算内，应主要由自旋取到
+    int ticks = 0;
+    TimerId every = loop.runEvery(0.0002, [&ticks]() { ++ticks; });
+    loop.runAfter(0.05, [&]() {
+        loop.cancel(every);
+        loop.runAfter(0.2, [&loop]() { loop.quit(); });  // 之后200ms空闲
+    });
+    loop.loop();
+
+    EventLoop::BusyPollStats stats = loop.busyPollStats();
+    assert(ticks > 0);
+    assert(stats.spinHits > 0);
+    assert(stats.spinPolls > 0);
+    assert(stats.blockingPolls > 0);  // 空闲阶段自旋窗口耗尽后会阻塞
+    assert(stats.spinWindowUs >= 0 && stats.spinWindowUs <= 5000);
+    std::cout << "TestBusyPoll passed!" << std::endl;
+}
+
+// 测试忙轮询下跨线程quit可以正常退出
+void TestBusyPollQuit() {
+    EventLoop loop;
+    loop.setBusyPoll(100000, 100000);  // 窗口固定为100ms
+    std::thread other([&loop]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        loop.quit();
+    });
+    loop.loop();
+    other.join();
+    std::cout << "TestBusyPollQuit passed!" << std::endl;
+}
+
+// 测试对数线性直方图的分桶与百分位
+void TestHistogram() {
+    LogLinearHistogram hist;
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        hist.record(v);
+    }
+    LogLinearHistogram::Snapshot snap = hist.snapshot();
+    assert(snap.count == 1000);
+    assert(snap.max == 1000);
+    assert(snap.mean() > 500.0 && snap.mean() < 501.0);
+    uint64_t p50 = snap.percentile(0.5);
+    uint64_t p99 = snap.percentile(0.99);
+    assert(p50 >= 500 && p50 <= 500 * 9 / 8 + 1);  // 相对误差不超过1/8
+    assert(p99 >= 990 && p99 <= 1000);
+    for (uint64_t v : {0ull, 7ull, 8ull, 1000ull, 123456789ull}) {
+        assert(LogLinearHistogram::bucketUpperBound(LogLinearHistogram::bucketOf(v)) >= v);
+    }
+    std::cout << "TestHistogram passed!" << std::endl;
+}
+
+// 测试运行指标：跨线程投递的回调与唤醒会被统计，且可在其他线程读取
+void TestMetrics() {
+    EventLoop loop;
+    std::thread producer([&loop]() {
+        for (int i = 0; i < 100; ++i) {
+            loop.queueInLoop([]() {});
+        }
+        loop.runAfter(0.02, [&loop]() { loop.quit(); });
+    });
+    loop.loop();
+    producer.join();
+
+    EventLoopMetrics::Snapshot snap;
+    std::thread reader([&]() { snap = loop.metricsSnapshot(); });
+    reader.join();
+    assert(snap.iterations > 0);
+    assert(snap.functors >= 100);
+    assert(snap.events > 0);  // 至少包含wakeup与timerfd事件
+    assert(snap.wakeupsHandled > 0 && snap.wakeupsWritten >= snap.wakeupsHandled);
+    assert(snap.pollWaitUs.count == snap.iterations);
+    assert(snap.pendingFunctorDepth.max >= 1);
+    std::cout << "TestMetrics passed!" << std::endl;
+}
+
+// 测试兴趣事件延迟提交：同一轮内的enableWriting/disableWriting互相抵消，且不影响事件投递
+void TestCoalescedUpdates() {
+    EventLoop loop;
+    int fds[2];
+    assert(::pipe(fds) == 0);
+    Channel channel(&loop, fds[0]);
+    int reads = 0;
+    channel.setReadCallback([&](TimeStamp) {
+        char buf[16];
+        assert(::read(fds[0], buf, sizeof buf) == 1);
+        ++reads;
+        loop.quit();
+    });
+    EventLoopMetrics::Snapshot before = loop.metricsSnapshot();
+    channel.enableReading();
+    for (int i = 0; i < 10; ++i) {
+        channel.enableWriting();
+        channel.disableWriting();
+    }
+    assert(::write(fds[1], "x", 1) == 1);
+    loop.loop();
+    assert(reads == 1);
+
+    EventLoopMetrics::Snapshot after = loop.metricsSnapshot();
+    assert(after.interestUpdates - before.interestUpdates == 21);
+    assert(after.interestUpdatesSaved - before.interestUpdatesSaved == 20);  // 只有一次EPOLL_CTL_ADD
+    channel.disableAll();
+    channel.remove();
+    ::close(fds[0]);
+    ::close(fds[1]);
+    std::cout << "TestCoalescedUpdates passed!" << std::endl;
+}
+
+// 测试边沿触发下同一轮内关闭又打开读：兴趣事件最终不变也要重新MOD，fd中剩余的数据再报告一次
+void TestEdgeTriggeredRearm() {
+    EventLoop loop;
+    int fds[2];
+    assert(::pipe(fds) == 0);
+    Channel channel(&loop, fds[0]);
+    channel.setEdgeTriggered(true);
+    int reads = 0;
+    channel.setReadCallback([&](TimeStamp) {
+        char c;
+        assert(::read(fds[0], &c, 1) == 1);  // 只读一个字节，剩余数据不会再产生边沿
+        if (++reads == 1) {
+            channel.disableReading();
+            channel.enableReading();
+        } else {
+            loop.quit();
+        }
+    });
+    channel.enableReading();
+    assert(::write(fds[1], "xy", 2) == 2);
+    loop.runAfter(1.0, [&loop]() { loop.quit(); });  // 没有再报告时避免卡住
+    loop.loop();
+    assert(reads == 2);
+
+    channel.disableAll();
+    channel.remove();
+    ::close(fds[0]);
+    ::close(fds[1]);
+    std::cout << "TestEdgeTriggeredRearm passed!" << std::endl;
+}
+
+// 运行loop直到某个回调quit()，最多timeout秒
+void loopFor(EventLoop& loop, double timeout) {
+    TimerId guard = loop.runAfter(timeout, [&loop]() { loop.quit(); });
+    loop.loop();
+    loop.cancel(guard);
+}
+
+// 测试以fd为下标的Channel表：fd被新Channel复用、remove后再次注册、表扩容、残留表项上的hasChannel
+void TestChannelTable() {
+    EventLoop loop;
+    int reads[3] = {0, 0, 0};
+    auto readOne = [&](int fd, int* counter) {
+        return [&loop, fd, counter](TimeStamp) {
+            char c;
+            assert(::read(fd, &c, 1) == 1);
+            ++*counter;
+            loop.quit();
+        };
+    };
+
+    int first[2];
+    assert(::pipe(first) == 0);
+    Channel stale(&loop, first[0]);
+    stale.setReadCallback(readOne(first[0], &reads[0]));
+    stale.enableReading();
+    assert(::write(first[1], "a", 1) == 1);
+    loopFor(loop, 1.0);
+    assert(reads[0] == 1 && loop.hasChannel(&stale));
+
+    // 关闭fd但不remove：表项残留，内核已自动把fd移出epoll；新的pipe复用同一个fd号
+    const int reusedFd = first[0];
+    ::close(first[0]);
+    ::close(first[1]);
+    int second[2];
+    assert(::pipe(second) == 0);
+    assert(second[0] == reusedFd);
+    Channel reused(&loop, second[0]);
+    reused.setReadCallback(readOne(second[0], &reads[1]));
+    reused.enableReading();  // 表项属于旧Channel，按新Channel重新ADD
+    assert(!loop.hasChannel(&stale) && loop.hasChannel(&reused));
+    assert(::write(second[1], "b", 1) == 1);
+    loopFor(loop, 1.0);
+    assert(reads[0] == 1 && reads[1] == 1);
+
+    // 已在内核中登记的Channel remove后在同一轮再次注册
+    reused.disableAll();
+    reused.remove();
+    assert(!loop.hasChannel(&reused));
+    reused.enableReading();
+    assert(loop.hasChannel(&reused));
+    assert(::write(second[1], "c", 1) == 1);
+    loopFor(loop, 1.0);
+    assert(reads[1] == 2);
+
+    // 远大于当前表长的fd触发扩容，已有表项的登记状态不变
+    rlimit limit;
+    assert(::getrlimit(RLIMIT_NOFILE, &limit) == 0);
+    const int target = static_cast<int>(std::min<rlim_t>(limit.rlim_cur - 1, 1000));
+    int third[2];
+    assert(::pipe(third) == 0);
+    int highFd = ::fcntl(third[0], F_DUPFD_CLOEXEC, target);
+    assert(highFd >= target);
+    Channel high(&loop, highFd);
+    high.setReadCallback(readOne(highFd, &reads[2]));
+    high.enableReading();
+    assert(loop.hasChannel(&reused) && loop.hasChannel(&high));
+    reused.disableReading();  // 扩容前登记为kAdded，应DEL而不是重复ADD
+    assert(::write(second[1], "d", 1) == 1);
+    assert(::write(third[1], "e", 1) == 1);
+    loopFor(loop, 1.0);
+    assert(reads[1] == 2 && reads[2] == 1);
+    reused.enableReading();
+    loopFor(loop, 1.0);
+    assert(reads[1] == 3);
+
+    high.disableAll();
+    high.remove();
+    reused.disableAll();
+    reused.remove();
+    ::close(highFd);
+    ::close(third[0]);
+    ::close(third[1]);
+    ::close(second[0]);
+    ::close(second[1]);
+    std::cout << "TestChannelTable passed!" << std::endl;
+}
+
+// 测试回调预算：大批回调分摊到多轮执行，每轮之间IO事件都能得到处理
+void TestFunctorBudget() {
+    EventLoop loop;
+    loop.setFunctorBudget(10);
+    int fds[2];
+    assert(::pipe(fds) == 0);
+    assert(::write(fds[1], "x", 1) == 1);
+    Channel channel(&loop, fds[0]);
+    int ticks = 0;
+    channel.setReadCallback([&ticks](TimeStamp) { ++ticks; });  // 不读走数据，LT模式每轮都会就绪
+    channel.enableReading();
+
+    const int kFunctors = 100;
+    std::vector<int> ranAtTick;
+    for (int i = 0; i < kFunctors; ++i) {
+        loop.queueInLoop([&]() {
+            ranAtTick.push_back(ticks);
+            if (ranAtTick.size() == kFunctors) {
+                loop.quit();
+            }
+        });
+    }
+    loop.loop();
+    assert(ranAtTick.size() == kFunctors);
+    for (int i = 0; i < kFunctors; ++i) {
+        assert(ranAtTick[i] == i / 10 + 1);  // 每轮处理一次IO事件后执行10个回调
+    }
+    channel.disableAll();
+    channel.remove();
+    ::close(fds[0]);
+    ::close(fds[1]);
+    std::cout << "TestFunctorBudget passed!" << std::endl;
+}
+
+// 测试quit()后再次loop()：上一次的quit_已复位，第二次循环正常运行；loop()开始前的quit()仍然有效
+void TestLoopRestart() {
+    EventLoop loop;
+    loop.quit();
+    loop.loop();  // 立即返回
+
+    int ran = 0;
+    loop.queueInLoop([&]() {
+        ++ran;
+        loop.quit();
+    });
+    loop.loop();
+    loop.runAfter(0.01, [&]() {
+        ++ran;
+        loop.quit();
+    });
+    loop.loop();
+    assert(ran == 2);
+    std::cout << "TestLoopRestart passed!" << std::endl;
+}
+
+// 测试loop析构时释放未执行的回调及其捕获的对象
+void TestPendingFunctorsReleased() {
+    auto captured = std::make_shared<int>(0);
+    {
+        EventLoop loop;
+        std::thread producer([&loop, captured]() {
+            for (int i = 0; i < 3; ++i) {
+                loop.queueInLoop([captured]() { ++*captured; });
+            }
+        });
+        producer.join();
+        assert(captured.use_count() == 4);
+    }
+    assert(captured.use_count() == 1 && *captured == 0);
+    std::cout << "TestPendingFunctorsReleased passed!" << std::endl;
+}
+
+int main() {
+    Logger::instance().setLogLevel(WARN);
+    TestBusyPoll();
+    TestBusyPollQuit();
+    TestHistogram();
+    TestMetrics();
+    TestCoalescedUpdates();
+    TestEdgeTriggeredRearm();
+    TestChannelTable();
+    TestFunctorBudget();
+    TestLoopRestart();
+    TestPendingFunctorsReleased();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
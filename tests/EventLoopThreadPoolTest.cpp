@@ -0,0 +1,120 @@
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+#include "EventLoop.h"
+#include "EventLoopThreadPool.h"
+#include "InetAddress.h"
+#include "Logger.h"
+
+// 测试放置计划：显式列表循环复用，未绑定策略全部为-1
+void TestPlanCpus() {
+    std::vector<int> plan = EventLoopThreadPool::planCpus(EventLoopThreadPool::kExplicitCpus, 5, {0, 2});
+    assert((plan == std::vector<int>{0, 2, 0, 2, 0}));
+    plan = EventLoopThreadPool::planCpus(EventLoopThreadPool::kNoAffinity, 3, {});
+    assert((plan == std::vector<int>{-1, -1, -1}));
+    for (auto policy : {EventLoopThreadPool::kOnePerPhysicalCore, EventLoopThreadPool::kSpreadNumaNodes}) {
+        plan = EventLoopThreadPool::planCpus(policy, 4, {});
+        assert(plan.size() == 4);
+        for (int cpu : plan) {
+            assert(cpu >= 0 && cpu < CPU_SETSIZE);
+        }
+    }
+    std::cout << "TestPlanCpus passed!" << std::endl;
+}
+
+// 测试loop线程在EventLoop创建前已绑定CPU，并且线程名被设置
+void TestPinnedThreads() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    assert(::sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+    int firstCpu = 0;
+    while (!CPU_ISSET(firstCpu, &allowed)) {
+        ++firstCpu;
+    }
+
+    EventLoop baseLoop;
+    EventLoopThreadPool pool(&baseLoop, "pinned");
+    pool.setThreadNum(2);
+    pool.setPlacement(EventLoopThreadPool::kExplicitCpus, {firstCpu});
+
+    std::mutex mutex;
+    std::set<std::string> names;
+    std::atomic<int> pinned{0};
+    pool.start([&](EventLoop*) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        ::pthread_getaffinity_np(::pthread_self(), sizeof(cpuset), &cpuset);
+        if (CPU_COUNT(&cpuset) == 1 && CPU_ISSET(firstCpu, &cpuset)) {
+            ++pinned;
+        }
+        char name[16] = {0};
+        ::pthread_getname_np(::pthread_self(), name, sizeof(name));
+        std::lock_guard<std::mutex> lock(mutex);
+        names.insert(name);
+    });
+    assert(pinned == 2);
+    assert(names.count("pinned1") == 1 && names.count("pinned2") == 1);
+    std::cout << "TestPinnedThreads passed!" << std::endl;
+}
+
+// 测试各分发策略的选择结果
+void TestDispatchPolicies() {
+    EventLoop baseLoop;
+    EventLoopThreadPool pool(&baseLoop, "dispatch");
+    pool.setThreadNum(3);
+    pool.start();
+    std::vector<EventLoop*> loops = pool.getAllLoops();
+
+    // 轮询
+    assert(pool.getNextLoop() == loops[0]);
+    assert(pool.getNextLoop() == loops[1]);
+    assert(pool.getNextLoop() == loops[2]);
+
+    // 最少连接：总是选连接数最小的loop，并列时轮流
+    pool.setDispatchPolicy(EventLoopThreadPool::kLeastConnections);
+    loops[0]->adjustConnectionCount(5);
+    loops[2]->adjustConnectionCount(1);
+    assert(pool.getNextLoop() == loops[1]);
+    loops[1]->adjustConnectionCount(3);
+    assert(pool.getNextLoop() == loops[2]);
+    loops[2]->adjustConnectionCount(4);
+    assert(pool.getNextLoop() == loops[1]);
+
+    // 两选一：被选中的两个loop中负载较高的永远不会被选中
+    pool.setDispatchPolicy(EventLoopThreadPool::kPowerOfTwoChoices);
+    for (EventLoop* loop : loops) {
+        loop->adjustConnectionCount(-loop->connectionCount());
+    }
+    loops[0]->adjustConnectionCount(1000);
+    for (int i = 0; i < 100; ++i) {
+        assert(pool.getNextLoop() != loops[0]);
+    }
+
+    // 按对端IP哈希：同一IP不同端口落在同一loop
+    pool.setDispatchPolicy(EventLoopThreadPool::kHashByPeer);
+    std::set<EventLoop*> used;
+    for (int host = 1; host < 64; ++host) {
+        std::string ip = "10.0.0." + std::to_string(host);
+        EventLoop* loop = pool.getNextLoop(InetAddress(ip, 1000));
+        assert(pool.getNextLoop(InetAddress(ip, 2000)) == loop);
+        used.insert(loop);
+    }
+    assert(used.size() == loops.size());
+    std::cout << "TestDispatchPolicies passed!" << std::endl;
+}
+
+int main() {
+    Logger::instance().setLogLevel(WARN);
+    TestPlanCpus();
+    TestPinnedThreads();
+    TestDispatchPolicies();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
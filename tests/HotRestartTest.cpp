@@ -0,0 +1,183 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "EventLoop.h"
+#include "HotRestart.h"
+#include "Logger.h"
+#include "TcpServer.h"
+#include "TestUtil.h"
+
+namespace {
+const uint16_t kPort = 19531;
+
+std::string readLine(int fd) {
+    std::string line;
+    char c;
+    while (::read(fd, &c, 1) == 1) {
+        line += c;
+        if (c == '\n') {
+            break;
+        }
+    }
+    return line;
+}
+
+void writeAll(int fd, const std::string& data) {
+    assert(::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+}
+
+// 按行回显并加上进程标签；不完整的行留在输入缓冲区中。收到"exit"时退出loop。
+// messages非空时统计上报次数，供测试等待数据到达
+void setupLineEcho(TcpServer* server, EventLoop* loop, const std::string& tag, std::atomic<int>* messages = nullptr) {
+    server->setConnectionCallback([](const TcpConnectionPtr&) {});
+    server->setMessageCallback([tag, loop, messages](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) {
+        if (messages != nullptr) {
+            ++*messages;
+        }
+        std::string data(buf->peek(), buf->readableBytes());
+        size_t pos;
+        while ((pos = data.find('\n')) != std::string::npos) {
+            std::string line = data.substr(0, pos);
+            data.erase(0, pos + 1);
+            buf->retrieve(pos + 1);
+            if (line == "exit") {
+                loop->quit();
+            } else {
+                conn->send(tag + ":" + line + "\n");
+            }
+        }
+    });
+}
+
+// 新进程：从旧进程接管监听socket和连接后继续服务
+int runNewProcess(const std::string& path, int startPipe) {
+    char c;
+    assert(::read(startPipe, &c, 1) == 1);
+    HotRestart::TakeOverState state;
+    if (!HotRestart::takeOver(path, &state)) {
+        return 1;
+    }
+    if (state.connections.size() != 1 || state.connections[0].pendingInput != "par") {
+        return 2;
+    }
+    EventLoop loop;
+    TcpServer server(&loop, state.listenFd, "New");
+    server.setThreadNum(1);
+    setupLineEcho(&server, &loop, "new");
+    server.start();
+    for (const HotRestart::InheritedConnection& inherited : state.connections) {
+        server.adoptConnection(inherited.sockfd, inherited.pendingInput);
+    }
+    loop.loop();
+    return 0;
+}
+}  // namespace
+
+// 旧进程持有一个带未完成输入的连接，交接后新进程继续处理该连接，并接受新的连接
+void TestHandOff() {
+    const std::string path = "/tmp/muduo_hot_restart_test_" + std::to_string(::getpid()) + ".sock";
+    int startPipe[2];
+    assert(::pipe(startPipe) == 0);
+    pid_t child = ::fork();  // 在创建任何线程之前fork
+    if (child == 0) {
+        ::close(startPipe[1]);
+        ::_exit(runNewProcess(path, startPipe[0]));
+    }
+    ::close(startPipe[0]);
+
+    bool handedOff = false;
+    std::atomic<int> messages(0);
+    ServerThread oldProcess([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer server(&loop, InetAddress("127.0.0.1", kPort), "Old");
+        server.setThreadNum(2);
+        setupLineEcho(&server, &loop, "old", &messages);
+        server.start();
+        HotRestart hot(&loop, &server, path);
+        hot.setHandOffCompleteCallback([&]() {
+            handedOff = true;
+            loop.quit();
+        });
+        hot.listen();
+        run(&loop);
+    });
+
+    int client = connectTo(kPort);
+    writeAll(client, "hello\n");
+    assert(readLine(client) == "old:hello\n");
+    int before = messages;
+    writeAll(client, "par");  // 不完整的行留在旧进程的输入缓冲区
+    assert(waitUntil([&]() { return messages > before; }));
+
+    assert(::write(startPipe[1], "x", 1) == 1);  // 启动升级
+    oldProcess.join();
+    assert(handedOff);
+
+    writeAll(client, "tial\n");
+    assert(readLine(client) == "new:partial\n");  // 旧进程中的"par"随连接交接
+    int another = connectTo(kPort);
+    writeAll(another, "world\n");
+    assert(readLine(another) == "new:world\n");
+    writeAll(another, "exit\n");
+    ::close(another);
+    ::close(client);
+
+    int status = 0;
+    assert(::waitpid(child, &status, 0) == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    ::close(startPipe[1]);
+    std::cout << "TestHandOff passed!" << std::endl;
+}
+
+// transfer失败：交接期间连接停止读（isReading()为false），失败后恢复读，连接继续服务
+void TestFailedHandOff() {
+    const uint16_t port = 19550;
+    TcpConnectionPtr serverConn;
+    std::atomic<bool> connected(false);
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "FailedHandOff");
+        setupLineEcho(&tcpServer, &loop, "kept");
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                serverConn = conn;
+                connected = true;
+            }
+        });
+        tcpServer.start();
+        run(&loop);
+        serverConn.reset();
+    });
+
+    int client = connectTo(port);
+    assert(waitUntil([&]() { return connected.load(); }));
+    bool readingDuringTransfer = true;
+    bool handedOff = true;
+    runInLoopAndWait(server.loop(), [&]() {
+        handedOff = serverConn->handOffInLoop([&](int, const std::string&) {
+            readingDuringTransfer = serverConn->isReading();
+            return false;
+        });
+    });
+    assert(!handedOff && !readingDuringTransfer);
+    assert(serverConn->isReading());
+    writeAll(client, "again\n");
+    assert(readLine(client) == "kept:again\n");
+
+    ::close(client);
+    server.stop();
+    std::cout << "TestFailedHandOff passed!" << std::endl;
+}
+
+int main() {
+    Logger::instance().setLogLevel(WARN);
+    TestHandOff();
+    TestFailedHandOff();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+
+#include "Channel.h"
+#include "EventLoop.h"
+#include "IoUringPoller.h"
+
+// 测试水平触发语义：一次只读1字节，剩余数据仍会在下一轮触发
+void TestLevelTriggered() {
+    EventLoop loop;
+    int sv[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+
+    int reads = 0;
+    Channel channel(&loop, sv[0]);
+    channel.setReadCallback([&](TimeStamp) {
+        char c;
+        if (::read(sv[0], &c, 1) == 1 && ++reads == 3) {
+            loop.quit();
+        }
+    });
+    channel.enableReading();
+    assert(::write(sv[1], "abc", 3) == 3);
+    loop.runAfter(1.0, [&loop]() { loop.quit(); });  // 防止失败时卡死
+    loop.loop();
+    assert(reads == 3);
+
+    channel.disableAll();
+    channel.remove();
+    ::close(sv[0]);
+    ::close(sv[1]);
+    std::cout << "TestLevelTriggered passed!" << std::endl;
+}
+
+// 测试修改关注事件：开启写事件后触发一次，关闭后不再触发
+void TestModifyInterest() {
+    EventLoop loop;
+    int sv[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+
+    int writes = 0;
+    Channel channel(&loop, sv[0]);
+    channel.setWriteCallback([&]() {
+        ++writes;
+        channel.disableWriting();
+    });
+    channel.enableReading();
+    channel.enableWriting();
+    loop.runAfter(0.05, [&loop]() { loop.quit(); });
+    loop.loop();
+    assert(writes == 1);
+
+    channel.disableAll();
+    channel.remove();
+    ::close(sv[0]);
+    ::close(sv[1]);
+    std::cout << "TestModifyInterest passed!" << std::endl;
+}
+
+// 测试出错的完成事件：poll请求以错误结束后仍会重新注册，Channel之后的事件不会丢失
+void TestRearmAfterError() {
+    EventLoop loop;
+    int stale[2], live[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, stale) == 0);
+    assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, live) == 0);
+    const int fd = stale[0];
+
+    bool readable = false;
+    Channel channel(&loop, fd);
+    channel.setReadCallback([&](TimeStamp) {
+        char c;
+        readable = ::read(fd, &c, 1) == 1;
+        loop.quit();
+    });
+    channel.enableReading();  // 只写入SQE，下一次poll才提交
+    ::close(fd);  // 提交时fd已失效，请求以-EBADF完成
+    // 第一轮poll收割错误完成事件后，把有数据的socket换到同一个fd上
+    loop.queueInLoop([&]() {
+        assert(::dup2(live[0], fd) == fd);
+        assert(::write(live[1], "x", 1) == 1);
+    });
+    loop.runAfter(1.0, [&loop]() { loop.quit(); });  // 防止失败时卡死
+    loop.loop();
+    assert(readable);
+
+    channel.disableAll();
+    channel.remove();
+    ::close(fd);
+    ::close(stale[1]);
+    ::close(live[0]);
+    ::close(live[1]);
+    std::cout << "TestRearmAfterError passed!" << std::endl;
+}
+
+int main() {
+    if (!IoUringPoller::isSupported()) {
+        std::cout << "io_uring not supported, skipped" << std::endl;
+        return 0;
+    }
+    ::setenv("MUDUO_USE_IO_URING", "1", 1);
+    TestLevelTriggered();
+    TestModifyInterest();
+    TestRearmAfterError();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
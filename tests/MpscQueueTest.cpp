@@ -0,0 +1,98 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "MpscQueue.h"
+
+namespace {
+struct IntNode : MpscNode {
+    explicit IntNode(int v = 0) : value(v) {}
+    int value;
+};
+}  // namespace
+
+// 测试 MpscQueue 的基本功能
+void TestBasicFunctionality() {
+    MpscQueue<IntNode> queue;
+    assert(queue.Pop() == nullptr);
+    assert(queue.Empty());
+
+    IntNode a(1), b(2);
+    queue.Push(&a);
+    queue.Push(&b);
+    assert(!queue.Empty());
+    assert(queue.Pop() == &a);
+    assert(queue.Pop() == &b);
+    assert(queue.Pop() == nullptr);
+    assert(queue.Empty());
+
+    std::cout << "TestBasicFunctionality passed!" << std::endl;
+}
+
+// 测试取空后重新放入哑节点：队列只剩一个元素时的出队，以及之后同一节点再次入队
+void TestStubReinsert() {
+    MpscQueue<IntNode> queue;
+    IntNode a(1), b(2);
+    for (int round = 0; round < 3; ++round) {
+        queue.Push(&a);
+        assert(queue.Pop() == &a);  // 最后一个元素，需重新入队哑节点
+        assert(queue.Pop() == nullptr);
+        assert(queue.Empty());
+
+        queue.Push(&a);  // 出队后的节点可以再次入队
+        queue.Push(&b);
+        assert(queue.Pop() == &a);
+        queue.Push(&a);  // 消费过程中交替入队
+        assert(queue.Pop() == &b);
+        assert(queue.Pop() == &a);
+        assert(queue.Pop() == nullptr);
+    }
+
+    std::cout << "TestStubReinsert passed!" << std::endl;
+}
+
+// 测试多生产者并发入队：每个生产者内部保持FIFO，且不丢失元素
+void TestMultiProducer() {
+    MpscQueue<IntNode> queue;
+    const int producers = 8;
+    const int perProducer = 50000;
+    std::vector<IntNode> nodes(producers * perProducer);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].value = static_cast<int>(i);
+    }
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, &nodes, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                queue.Push(&nodes[p * perProducer + i]);
+            }
+        });
+    }
+
+    std::vector<int> last(producers, -1);
+    int received = 0;
+    while (received < producers * perProducer) {
+        if (IntNode* node = queue.Pop()) {
+            int p = node->value / perProducer;
+            assert(node->value % perProducer > last[p]);
+            last[p] = node->value % perProducer;
+            ++received;
+        }
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(queue.Pop() == nullptr);
+
+    std::cout << "TestMultiProducer passed!" << std::endl;
+}
+
+int main() {
+    TestBasicFunctionality();
+    TestStubReinsert();
+    TestMultiProducer();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EventLoop.h"
+#include "Logger.h"
+#include "TcpClient.h"
+#include "TcpServer.h"
+#include "UpstreamPool.h"
+
+namespace {
+void echo(const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) {
+    conn->send(buf->retrieveAllAsString());
+}
+
+// 测试卡住时直接失败，而不是挂起ctest
+void watchdog(EventLoop* loop, double seconds) {
+    loop->runAfter(seconds, []() {
+        std::cerr << "timed out" << std::endl;
+        std::abort();
+    });
+}
+}  // namespace
+
+// 客户端与服务端共用TcpConnection：连接、收发、半关闭后双方都看到断开
+void TestClientEcho() {
+    EventLoop loop;
+    watchdog(&loop, 5);
+    InetAddress addr("127.0.0.1", 19533);
+    TcpServer server(&loop, addr, "EchoServer");
+    server.setConnectionCallback([](const TcpConnectionPtr&) {});
+    server.setMessageCallback(echo);
+    server.start();
+
+    TcpClient client(&loop, addr, "EchoClient");
+    std::string received;
+    bool disconnected = false;
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            assert(client.connection() == conn);
+            conn->send("hello client");
+        } else {
+            disconnected = true;
+            loop.quit();
+        }
+    });
+    client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, TimeStamp) {
+        received += buf->retrieveAllAsString();
+        if (received.size() == 12) {
+            client.disconnect();
+        }
+    });
+    client.connect();
+    loop.loop();
+
+    assert(received == "hello client");
+    assert(disconnected);
+    assert(!client.connection());
+    std::cout << "TestClientEcho passed!" << std::endl;
+}
+
+// 对端未监听：按指数退避重试，次数用尽后回调失败
+void TestRetryBackoff() {
+    EventLoop loop;
+    watchdog(&loop, 5);
+    TcpClient client(&loop, InetAddress("127.0.0.1", 19534), "RetryClient");
+    client.connector().setRetryDelay(0.05, 0.1);
+    client.connector().setMaxRetries(3);
+    int failures = 0;
+    client.setConnectionCallback([](const TcpConnectionPtr&) { assert(false); });
+    TimeStamp start = TimeStamp::now();
+    TimeStamp failedAt;
+    client.setConnectFailedCallback([&]() {
+        ++failures;
+        failedAt = TimeStamp::now();
+        loop.runAfter(0.2, [&loop]() { loop.quit(); });  // 确认不会再重试
+    });
+    client.connect();
+    loop.loop();
+
+    assert(failures == 1);
+    double elapsed = timeDifference(failedAt, start);
+    assert(elapsed >= 0.05 + 0.1 + 0.1);  // 第三次等待被限制在上限0.1秒
+    assert(elapsed < 2);
+    std::cout << "TestRetryBackoff passed!" << std::endl;
+}
+
+// 服务端晚于客户端启动：重试到服务端可用为止；连接被断开后enableRetry自动重连
+void TestReconnect() {
+    EventLoop loop;
+    watchdog(&loop, 5);
+    InetAddress addr("127.0.0.1", 19534);
+    std::unique_ptr<TcpServer> server;
+    int serverConnections = 0;
+
+    TcpClient client(&loop, addr, "ReconnectClient");
+    client.connector().setRetryDelay(0.05, 0.05);
+    client.enableRetry();
+    int connects = 0;
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (!conn->connected()) {
+            return;
+        }
+        if (++connects == 2) {
+            client.stop();
+            client.disconnect();
+            loop.runAfter(0.1, [&loop]() { loop.quit(); });
+        }
+    });
+    client.setMessageCallback([](const TcpConnectionPtr&, Buffer*, TimeStamp) {});
+    client.connect();
+
+    loop.runAfter(0.2, [&]() {
+        server.reset(new TcpServer(&loop, addr, "LateServer"));
+        server->setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected() && ++serverConnections == 1) {
+                conn->shutdown();  // 服务端主动断开第一个连接，客户端应重连
+            }
+        });
+        server->setMessageCallback(echo);
+        server->start();
+    });
+    loop.loop();
+
+    assert(connects == 2);
+    assert(serverConnections == 2);
+    std::cout << "TestReconnect passed!" << std::endl;
+}
+
+// 连接池：按最少在途请求选择连接，达到上限后复用，空闲连接超出上限或超时后关闭
+void TestUpstreamPool() {
+    EventLoop loop;
+    watchdog(&loop, 5);
+    InetAddress addr("127.0.0.1", 19535);
+    TcpServer server(&loop, addr, "Upstream");
+    server.setConnectionCallback([](const TcpConnectionPtr&) {});
+    server.setMessageCallback(echo);
+    server.start();
+
+    UpstreamPool pool(&loop, "Pool");
+    pool.setMaxConnectionsPerUpstream(2);
+    pool.setMaxIdlePerUpstream(1);
+    pool.setIdleTimeout(0.3);
+    pool.setHealthCheck(0.05, nullptr);
+
+    std::vector<TcpConnectionPtr> got;
+    pool.acquire(addr, [&](const TcpConnectionPtr& conn) {
+        assert(conn && conn->connected());
+        got.push_back(conn);
+        // 第一个连接在忙，且未达上限：新建第二个连接
+        pool.acquire(addr, [&](const TcpConnectionPtr& conn) {
+            got.push_back(conn);
+            assert(got[0] != got[1]);
+            assert(pool.connectionCount(addr) == 2);
+            // 达到上限：复用在途请求最少的连接
+            pool.acquire(addr, [&](const TcpConnectionPtr& conn) {
+                got.push_back(conn);
+                assert(pool.inflight(conn) == 2);
+            });
+            assert(got.size() == 3);
+            for (const TcpConnectionPtr& c : got) {
+                pool.release(c);
+            }
+            got.clear();
+        });
+    });
+
+    // 释放后空闲连接超过上限1，多出的一个被关闭
+    loop.runAfter(0.15, [&]() {
+        assert(pool.connectionCount(addr) == 1);
+        assert(pool.idleCount(addr) == 1);
+        pool.acquire(addr, [&](const TcpConnectionPtr& conn) {
+            assert(conn);
+            assert(pool.inflight(conn) == 1);
+            pool.release(conn);
+        });
+        assert(pool.connectionCount(addr) == 1);  // 复用空闲连接，没有新建
+    });
+    // 空闲超时后被巡检关闭
+    loop.runAfter(0.8, [&]() {
+        assert(pool.connectionCount(addr) == 0);
+        loop.quit();
+    });
+    loop.loop();
+
+    std::cout << "TestUpstreamPool passed!" << std::endl;
+}
+
+// 上游不可达：排队的请求全部以nullptr失败
+void TestUpstreamPoolConnectFailure() {
+    EventLoop loop;
+    watchdog(&loop, 5);
+    InetAddress addr("127.0.0.1", 19536);
+    UpstreamPool pool(&loop, "DeadPool");
+    pool.setConnectRetries(0);
+    int failures = 0;
+    for (int i = 0; i < 3; ++i) {
+        pool.acquire(addr, [&](const TcpConnectionPtr& conn) {
+            assert(!conn);
+            if (++failures == 3) {
+                loop.quit();
+            }
+        });
+    }
+    loop.loop();
+    assert(failures == 3);
+    assert(pool.connectionCount(addr) == 0);
+    std::cout << "TestUpstreamPoolConnectFailure passed!" << std::endl;
+}
+
+int main() {
+    Logger::instance().setLogLevel(WARN);
+    TestClientEcho();
+    TestRetryBackoff();
+    TestReconnect();
+    TestUpstreamPool();
+    TestUpstreamPoolConnectFailure();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
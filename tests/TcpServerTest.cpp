@@ -0,0 +1,665 @@
+#include <fcntl.h>
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EventLoop.h"
+#include "Logger.h"
+#include "SlabPool.h"
+#include "TcpServer.h"
+#include "TestUtil.h"
+
+namespace {
+void echoOnce(int fd, const std::string& msg) {
+    assert(::write(fd, msg.data(), msg.size()) == static_cast<ssize_t>(msg.size()));
+    std::string echoed;
+    char buf[256];
+    while (echoed.size() < msg.size()) {
+        ssize_t n = ::read(fd, buf, sizeof buf);
+        assert(n > 0);
+        echoed.append(buf, n);
+    }
+    assert(echoed == msg);
+}
+
+/**
+ * ET：同一轮循环内暂停又恢复读，socket中还留有未读的数据。
+ * 读回调读满预算后因发送缓冲区达到高水位暂停读，预算续读任务随之跳过；
+ * 同一事件的写回调和其后的续写任务把发送缓冲区写到低水位以下，在同一轮恢复读。
+ * 剩余的请求数据不会再有边沿，只能靠恢复时重新注册报告。
+ **/
+void checkResumeWithinIteration() {
+    const uint16_t port = 19546;
+    const size_t kBudget = 16 * 1024;
+    const size_t kHighWaterMark = 256 * 1024;
+    const size_t kResponse = kHighWaterMark + kBudget;  // 立即写出一个预算后正好停在高水位
+    const size_t kRequest = 4 * kBudget;  // 第一次只读一个预算，其余留在socket中
+    TcpConnectionPtr serverConn;
+    std::atomic<bool> connected(false);
+    std::atomic<size_t> consumed(0);
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "ResumeWithinIteration");
+        tcpServer.setEdgeTriggered(true);
+        tcpServer.setEventByteBudget(kBudget);
+        // 写回调（240K）和第一个续写任务（224K）之后仍高于低水位，第二个续写任务（208K）之后恢复
+        tcpServer.setReadBackpressure(kHighWaterMark, kHighWaterMark - 5 * kBudget / 2);
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                serverConn = conn;
+                connected = true;
+            }
+        });
+        tcpServer.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) {
+            size_t n = buf->readableBytes();
+            buf->retrieveAll();
+            if (consumed.fetch_add(n) == 0) {
+                conn->appendToOutput([&](ChainBuffer* output) {
+                    std::string response(kResponse, 'R');
+                    output->append(response.data(), response.size());
+                });
+            }
+        });
+        tcpServer.start();
+        run(&loop);
+        serverConn.reset();
+    });
+    EventLoop* serverLoop = server.loop();
+    int fd = connectTo(port);
+    assert(waitUntil([&]() { return connected.load(); }));
+
+    // loop阻塞期间写入整个请求，保证第一次读事件时数据已全部到达
+    auto blocked = std::make_shared<std::promise<void>>();
+    auto release = std::make_shared<std::promise<void>>();
+    std::future<void> loopBlocked = blocked->get_future();
+    std::shared_future<void> released = release->get_future().share();
+    serverLoop->queueInLoop([blocked, released]() {
+        blocked->set_value();
+        released.wait();
+    });
+    loopBlocked.wait();
+    std::string request(kRequest, 'q');
+    assert(::write(fd, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+    assert(waitUntil([&]() {
+        int unsent = 0;
+        return ::ioctl(fd, SIOCOUTQ, &unsent) == 0 && unsent == 0;
+    }));
+    release->set_value();
+
+    size_t received = 0;
+    std::vector<char> readBuf(64 * 1024);
+    while (received < kResponse) {
+        ssize_t n = ::read(fd, readBuf.data(), readBuf.size());
+        assert(n > 0);
+        received += n;
+    }
+    assert(waitUntil([&]() { return consumed == kRequest; }));
+
+    ::close(fd);
+    server.stop();
+}
+}  // namespace
+
+// 每loop Acceptor模式：连接直接由subloop accept，mainLoop不参与，连接分布到多个loop
+void TestAcceptorPerLoop(bool cpuSteering) {
+    const uint16_t port = 19528;
+    const int kClients = 32;
+    std::mutex mutex;
+    std::map<EventLoop*, int> connectionsPerLoop;
+    std::atomic<int> closed{0};
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "PerLoop");
+        tcpServer.setThreadNum(2);
+        tcpServer.setAcceptorPerLoop(true, cpuSteering);
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            assert(conn->getLoop()->isInLoopThread());
+            if (conn->connected()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++connectionsPerLoop[conn->getLoop()];
+            } else {
+                ++closed;
+            }
+        });
+        tcpServer.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) { conn->send(buf->retrieveAllAsString()); });
+        tcpServer.start();
+        run(&loop);
+    });
+    EventLoop* serverLoop = server.loop();
+
+    std::vector<int> fds;
+    for (int i = 0; i < kClients; ++i) {
+        fds.push_back(connectTo(port));
+        echoOnce(fds.back(), "hello " + std::to_string(i));
+    }
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    assert(waitUntil([&]() { return closed == kClients; }));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        assert(connectionsPerLoop.count(serverLoop) == 0);
+        int total = 0;
+        for (const auto& item : connectionsPerLoop) {
+            total += item.second;
+        }
+        assert(total == kClients);
+        if (!cpuSteering) {  // 按四元组哈希分发，32个连接全部落在同一loop的概率可以忽略
+            assert(connectionsPerLoop.size() == 2);
+        }
+    }
+
+    server.stop();
+    std::cout << "TestAcceptorPerLoop(cpuSteering=" << cpuSteering << ") passed!" << std::endl;
+}
+
+// 处理完请求的空闲连接不持有缓冲区内存：输入缓冲区读完即归还slabPool，输出缓冲区发完即归还
+void TestIdleConnectionFootprint() {
+    const uint16_t port = 19537;
+    const int kClients = 50;
+    std::atomic<int> connected{0};
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "Footprint");
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                ++connected;
+            }
+        });
+        tcpServer.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) { conn->send(buf->retrieveAllAsString()); });
+        tcpServer.start();
+        run(&loop);
+    });
+    EventLoop* serverLoop = server.loop();
+
+    std::vector<int> fds;
+    for (int i = 0; i < kClients; ++i) {
+        fds.push_back(connectTo(port));
+        echoOnce(fds.back(), std::string(4000 + i, 'x'));
+    }
+    assert(connected == kClients);
+    // 客户端收到回显时服务端可能还在messageCallback中，等其返回
+    assert(waitUntil([&]() { return serverLoop->metricsSnapshot().bufferBytesInUse == 0; }));
+    EventLoopMetrics::Snapshot snap = serverLoop->metricsSnapshot();
+    assert(snap.bufferBytesCached > 0);
+
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    server.stop();
+    std::cout << "TestIdleConnectionFootprint passed!" << std::endl;
+}
+
+// 广播：同一个SharedSlice发给多个连接，写不完的部分只以引用留在各自的发送队列中
+void TestBroadcastSharedSlice() {
+    const uint16_t port = 19538;
+    const int kClients = 4;
+    std::mutex mutex;
+    std::vector<TcpConnectionPtr> conns;
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "Broadcast");
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                conns.push_back(conn);
+            }
+        });
+        tcpServer.setMessageCallback([](const TcpConnectionPtr&, Buffer* buf, TimeStamp) { buf->retrieveAll(); });
+        tcpServer.start();
+        run(&loop);
+        std::lock_guard<std::mutex> lock(mutex);
+        conns.clear();
+    });
+
+    std::vector<int> fds;
+    for (int i = 0; i < kClients; ++i) {
+        int fd = connectTo(port);
+        int rcvbuf = 64 * 1024;  // 关闭接收窗口自动调优，保证数据积压在服务端
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf);
+        fds.push_back(fd);
+    }
+    assert(waitUntil([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return conns.size() == kClients;
+    }));
+
+    std::string content(16 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>(i * 31 % 251);
+    }
+    SharedSlice payload(content);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const TcpConnectionPtr& conn : conns) {
+            conn->send(payload);  // 跨线程：只拷贝引用
+        }
+    }
+    // 客户端还没读，16MB超出两端socket缓冲区，各连接的发送队列引用着同一份存储
+    // （等投递到loop的任务对象析构后，引用只剩发送队列里的）
+    assert(waitUntil([&]() { return payload.useCount() == kClients + 1; }));
+
+    std::vector<char> readBuf(1 << 20);
+    for (int fd : fds) {
+        std::string received;
+        received.reserve(content.size());
+        while (received.size() < content.size()) {
+            ssize_t n = ::read(fd, readBuf.data(), readBuf.size());
+            assert(n > 0);
+            received.append(readBuf.data(), n);
+        }
+        assert(received == content);
+    }
+    // 全部写完后引用释放（最后一次写在loop线程中完成）
+    assert(waitUntil([&]() { return payload.useCount() == 1; }));
+
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    server.stop();
+    std::cout << "TestBroadcastSharedSlice passed!" << std::endl;
+}
+
+// 零拷贝发送：直接发送和排队后发送两条路径的数据都完整，完成通知到达后释放对存储的引用；
+// 回环上内核总是复制，收到通知后连接自动回到普通发送
+void TestZeroCopySend() {
+    const uint16_t port = 19539;
+    std::string content(8 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>(i * 131 % 253);
+    }
+    SharedSlice first(content.substr(0, content.size() / 2));
+    SharedSlice second(content.substr(content.size() / 2));
+    std::atomic<int> supported(-1);
+    TcpConnectionPtr serverConn;
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "ZeroCopy");
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                serverConn = conn;
+                conn->setZeroCopyThreshold(64 * 1024);
+                supported = conn->zeroCopyEnabled() ? 1 : 0;
+                conn->send(first);  // 直接发送，写不完的部分以共享段排队
+                conn->send(second);  // 排在队列中，EPOLLOUT时零拷贝发送
+            }
+        });
+        tcpServer.setMessageCallback([](const TcpConnectionPtr&, Buffer* buf, TimeStamp) { buf->retrieveAll(); });
+        tcpServer.start();
+        run(&loop);
+        serverConn.reset();
+    });
+    EventLoop* serverLoop = server.loop();
+
+    int fd = connectTo(port);
+    std::string received;
+    std::vector<char> readBuf(256 * 1024);
+    while (received.size() < content.size()) {
+        ssize_t n = ::read(fd, readBuf.data(), readBuf.size());
+        assert(n > 0);
+        received.append(readBuf.data(), n);
+    }
+    assert(received == content);
+    assert(waitUntil([&]() { return first.useCount() == 1 && second.useCount() == 1; }));
+    if (supported == 1) {
+        bool enabled = true;
+        runInLoopAndWait(serverLoop, [&]() { enabled = serverConn->zeroCopyEnabled(); });
+        assert(!enabled);
+    }
+
+    ::close(fd);
+    server.stop();
+    std::cout << "TestZeroCopySend passed! (SO_ZEROCOPY " << (supported == 1 ? "supported" : "unsupported") << ")" << std::endl;
+}
+
+// 各发送重载：loop线程内外混合调用，数据按调用顺序到达，移交的缓冲区被清空
+void TestSendOverloads() {
+    const uint16_t port = 19540;
+    TcpConnectionPtr serverConn;
+    std::atomic<bool> connected(false);
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "SendOverloads");
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                serverConn = conn;
+                connected = true;
+            }
+        });
+        // loop线程内：输入缓冲区直接写回，appendToOutput直接序列化进发送缓冲区
+        tcpServer.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) {
+            conn->send(buf);
+            assert(buf->readableBytes() == 0);
+            conn->appendToOutput([](ChainBuffer* output) { output->append("|serialized", 11); });
+        });
+        tcpServer.start();
+        run(&loop);
+        serverConn.reset();
+    });
+    EventLoop* serverLoop = server.loop();
+    int fd = connectTo(port);
+    assert(waitUntil([&]() { return connected.load(); }));
+
+    // 其他线程：右值、指针+长度、Buffer交换
+    std::string moved(100 * 1024, 'm');
+    serverConn->send(std::move(moved));
+    serverConn->send("|raw", 4);
+    Buffer owned;
+    owned.append("|buffer", 7);
+    serverConn->send(&owned);
+    assert(owned.readableBytes() == 0);
+    runInLoopAndWait(serverLoop, []() {});  // 跨线程的发送都已执行后再触发loop线程内的发送
+    ::write(fd, "|echo", 5);
+
+    std::string expected = std::string(100 * 1024, 'm') + "|raw|buffer|echo|serialized";
+    std::string received;
+    char readBuf[65536];
+    while (received.size() < expected.size()) {
+        ssize_t n = ::read(fd, readBuf, sizeof readBuf);
+        assert(n > 0);
+        received.append(readBuf, n);
+    }
+    assert(received == expected);
+
+    ::close(fd);
+    server.stop();
+    std::cout << "TestSendOverloads passed!" << std::endl;
+}
+
+// 读反压：只发不收的客户端让发送缓冲区停在高水位附近；客户端开始读后恢复读取，数据完整。
+// 另外检查stopRead/startRead手动暂停
+void TestReadBackpressure(bool edgeTriggered) {
+    const uint16_t port = edgeTriggered ? 19542 : 19541;
+    const size_t kHighWaterMark = 1024 * 1024;
+    const size_t kAmplification = 4;  // 每字节请求回4字节响应
+    TcpConnectionPtr serverConn;
+    std::atomic<bool> connected(false);
+    std::atomic<size_t> messages(0);
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "Backpressure");
+        tcpServer.setEdgeTriggered(edgeTriggered);
+        tcpServer.setEventByteBudget(64 * 1024);
+        tcpServer.setReadBackpressure(kHighWaterMark, kHighWaterMark / 4);
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                serverConn = conn;
+                connected = true;
+            }
+        });
+        tcpServer.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) {
+            ++messages;
+            std::string request = buf->retrieveAllAsString();
+            for (size_t i = 0; i < kAmplification; ++i) {
+                conn->send(request);
+            }
+        });
+        tcpServer.start();
+        run(&loop);
+        serverConn.reset();
+    });
+    EventLoop* serverLoop = server.loop();
+    int fd = connectTo(port);
+    assert(waitUntil([&]() { return connected.load(); }));
+
+    // 手动暂停：暂停期间的数据不上报，恢复后上报
+    serverConn->stopRead();
+    runInLoopAndWait(serverLoop, []() {});  // stopRead已在loop线程生效
+    ::write(fd, "p", 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // 没有事件可等：给loop足够时间确认数据没有上报
+    assert(messages == 0);
+    serverConn->startRead();
+    char c;
+    assert(::read(fd, &c, 1) == 1 && c == 'p');
+    for (size_t i = 1; i < kAmplification; ++i) {
+        assert(::read(fd, &c, 1) == 1);
+    }
+
+    // 只发不收：写到客户端发送缓冲区也满为止，期间服务端输出缓冲区不会无限增长
+    ::fcntl(fd, F_SETFL, O_NONBLOCK);
+    const size_t kTotal = 64 * 1024 * 1024;
+    std::string chunk(64 * 1024, 'r');
+    size_t written = 0;
+    size_t peak = 0;
+    int stalls = 0;
+    while (written < kTotal && stalls < 20) {
+        ssize_t n = ::write(fd, chunk.data(), std::min(chunk.size(), kTotal - written));
+        if (n > 0) {
+            written += n;
+            stalls = 0;
+        } else {
+            ++stalls;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        peak = std::max(peak, serverLoop->metricsSnapshot().bufferBytesInUse);
+    }
+    assert(written < kTotal);  // 服务端停止读取，TCP流控挡住了客户端
+    // 暂停前最后一次事件最多再产生 预算 * 放大倍数 的输出，加上slab取整
+    assert(peak <= kHighWaterMark + 64 * 1024 * kAmplification + 64 * 1024);
+
+    // 客户端开始读：服务端写到低水位后恢复读取，剩余请求继续处理
+    size_t received = 0;
+    std::vector<char> readBuf(256 * 1024);
+    while (received < kTotal * kAmplification) {
+        ssize_t n = ::read(fd, readBuf.data(), readBuf.size());
+        if (n > 0) {
+            received += n;
+        }
+        if (written < kTotal) {
+            ssize_t w = ::write(fd, chunk.data(), std::min(chunk.size(), kTotal - written));
+            if (w > 0) {
+                written += w;
+            }
+        }
+        if (n <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    assert(received == kTotal * kAmplification);
+
+    ::close(fd);
+    server.stop();
+    if (edgeTriggered) {
+        checkResumeWithinIteration();
+    }
+    std::cout << "TestReadBackpressure(edgeTriggered=" << edgeTriggered << ") passed!" << std::endl;
+}
+
+// 空闲超时：不发数据的连接在读空闲超时后被关闭，持续发数据的连接保持
+void TestIdleTimeout() {
+    const uint16_t port = 19543;
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "IdleTimeout");
+        tcpServer.setIdleTimeouts(1.0, 0, 0);
+        tcpServer.setConnectionCallback([](const TcpConnectionPtr&) {});
+        tcpServer.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, TimeStamp) { conn->send(buf); });
+        tcpServer.start();
+        run(&loop);
+    });
+
+    int idle = connectTo(port);
+    int active = connectTo(port);
+    TimeStamp start = TimeStamp::now();
+    for (int i = 0; i < 10; ++i) {  // 2.5秒内每0.25秒一次请求
+        echoOnce(active, "ping");
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    }
+    // 空闲连接早已被关闭：读到EOF
+    char c;
+    assert(::read(idle, &c, 1) == 0);
+    assert(timeDifference(TimeStamp::now(), start) >= 1.0);
+    echoOnce(active, "still open");
+
+    ::close(idle);
+    ::close(active);
+    server.stop();
+    std::cout << "TestIdleTimeout passed!" << std::endl;
+}
+
+// 文件发送：普通文件、管道、socket三种源与缓冲数据交错排队，按顺序完整到达；
+// socket写满时靠EPOLLOUT续传不空转；全部写出后只调用一次WriteCompleteCallback
+void TestSendFile(bool edgeTriggered) {
+    const uint16_t port = edgeTriggered ? 19545 : 19544;
+    std::string head(4 * 1024 * 1024, 'h');  // 足够大，保证文件排在缓冲数据之后
+    std::string fileContent(8 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < fileContent.size(); ++i) {
+        fileContent[i] = static_cast<char>(i * 7 % 251);
+    }
+    char path[] = "/tmp/tcp_server_test_XXXXXX";
+    int fileFd = ::mkstemp(path);
+    assert(fileFd >= 0);
+    ::unlink(path);
+    assert(::write(fileFd, fileContent.data(), fileContent.size()) == static_cast<ssize_t>(fileContent.size()));
+    int pipeFds[2];
+    assert(::pipe(pipeFds) == 0);
+    int sockFds[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockFds) == 0);
+    std::string streamContent(1024 * 1024, 's');
+    auto slowWriter = [&streamContent](int fd) {
+        for (size_t off = 0; off < streamContent.size(); off += 64 * 1024) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            assert(::write(fd, streamContent.data() + off, 64 * 1024) == 64 * 1024);
+        }
+        ::close(fd);
+    };
+
+    std::atomic<int> writeCompletes(0);
+    std::atomic<bool> queued(false);
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "SendFile");
+        tcpServer.setEdgeTriggered(edgeTriggered);
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                conn->send(head);
+                conn->sendFile(fileFd, 1000, fileContent.size() - 1000);
+                conn->send("|pipe|");
+                conn->sendFile(pipeFds[0], 0, streamContent.size());
+                conn->send("|socket|");
+                conn->sendFile(sockFds[0], 0, SIZE_MAX);  // 直到对端关闭
+                conn->send("|end");
+                queued = true;
+            }
+        });
+        tcpServer.setMessageCallback([](const TcpConnectionPtr&, Buffer* buf, TimeStamp) { buf->retrieveAll(); });
+        tcpServer.setWriteCompleteCallback([&](const TcpConnectionPtr&) { ++writeCompletes; });
+        tcpServer.start();
+        run(&loop);
+    });
+    EventLoop* serverLoop = server.loop();
+    int fd = connectTo(port);
+    std::thread pipeWriter(slowWriter, pipeFds[1]);
+    std::thread socketWriter(slowWriter, sockFds[1]);
+
+    // 客户端暂不读：发送队列停在socket写满处，loop应当阻塞在epoll_wait而不是空转
+    assert(waitUntil([&]() { return queued.load(); }));
+    uint64_t iterations = serverLoop->metricsSnapshot().iterations;
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));  // 观察窗口
+    assert(serverLoop->metricsSnapshot().iterations - iterations < 50);
+
+    std::string expected = head + fileContent.substr(1000) + "|pipe|" + streamContent + "|socket|" + streamContent + "|end";
+    std::string received;
+    std::vector<char> readBuf(256 * 1024);
+    while (received.size() < expected.size()) {
+        ssize_t n = ::read(fd, readBuf.data(), readBuf.size());
+        assert(n > 0);
+        received.append(readBuf.data(), n);
+    }
+    assert(received == expected);
+    assert(waitUntil([&]() { return writeCompletes > 0; }));
+    assert(writeCompletes == 1);
+
+    pipeWriter.join();
+    socketWriter.join();
+    ::close(fd);
+    server.stop();
+    ::close(fileFd);
+    ::close(pipeFds[0]);
+    ::close(sockFds[0]);
+    std::cout << "TestSendFile(edgeTriggered=" << edgeTriggered << ") passed!" << std::endl;
+}
+
+// 文件发送中途连接关闭：连接与等待中的管道源在同一次poll中就绪，关闭时源Channel从Poller移除，
+// 且要等本轮事件处理完才能析构；之后管道中未读的数据不再让loop空转
+void TestCloseDuringFileTransfer(bool edgeTriggered) {
+    const uint16_t port = edgeTriggered ? 19552 : 19551;
+    int pipeFds[2];
+    assert(::pipe(pipeFds) == 0);
+    std::atomic<bool> queued(false);
+    std::atomic<bool> closed(false);
+    ServerThread server([&](const ServerThread::Run& run) {
+        EventLoop loop;
+        TcpServer tcpServer(&loop, InetAddress("127.0.0.1", port), "CloseDuringFileTransfer");
+        tcpServer.setEdgeTriggered(edgeTriggered);
+        tcpServer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                conn->sendFile(pipeFds[0], 0, 1024 * 1024);  // 管道为空，在源上等待可读
+                queued = true;
+            } else {
+                closed = true;
+            }
+        });
+        tcpServer.start();
+        run(&loop);
+    });
+    EventLoop* serverLoop = server.loop();
+    int fd = connectTo(port);
+    assert(waitUntil([&]() { return queued.load(); }));
+
+    // loop阻塞期间对端关闭、源变为可读，放开后两者在同一次poll中返回，连接先处理
+    auto blocked = std::make_shared<std::promise<void>>();
+    auto release = std::make_shared<std::promise<void>>();
+    std::future<void> loopBlocked = blocked->get_future();
+    std::shared_future<void> released = release->get_future().share();
+    serverLoop->queueInLoop([blocked, released]() {
+        blocked->set_value();
+        released.wait();
+    });
+    loopBlocked.wait();
+    ::close(fd);
+    std::string chunk(4096, 'p');
+    assert(::write(pipeFds[1], chunk.data(), chunk.size()) == static_cast<ssize_t>(chunk.size()));
+    release->set_value();
+    assert(waitUntil([&]() { return closed.load(); }));
+
+    runInLoopAndWait(serverLoop, []() {});
+    uint64_t iterations = serverLoop->metricsSnapshot().iterations;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // 观察窗口：管道仍可读，但已没有Channel关注它
+    assert(serverLoop->metricsSnapshot().iterations - iterations < 10);
+
+    server.stop();
+    ::close(pipeFds[0]);
+    ::close(pipeFds[1]);
+    std::cout << "TestCloseDuringFileTransfer(edgeTriggered=" << edgeTriggered << ") passed!" << std::endl;
+}
+
+int main() {
+    Logger::instance().setLogLevel(WARN);
+    TestAcceptorPerLoop(false);
+    TestAcceptorPerLoop(true);
+    TestIdleConnectionFootprint();
+    TestBroadcastSharedSlice();
+    TestZeroCopySend();
+    TestSendOverloads();
+    TestReadBackpressure(false);
+    TestReadBackpressure(true);
+    TestIdleTimeout();
+    TestSendFile(false);
+    TestSendFile(true);
+    TestCloseDuringFileTransfer(false);
+    TestCloseDuringFileTransfer(true);
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
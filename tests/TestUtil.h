@@ -0,0 +1,106 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "EventLoop.h"
+
+// 网络测试共用的工具：后台线程运行服务端loop、按条件等待、同步执行loop线程任务
+
+// 连接本机端口，服务端刚开始监听时稍作重试
+inline int connectTo(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int ret = -1;
+    for (int i = 0; i < 100 && ret != 0; ++i) {
+        ret = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr);
+        if (ret != 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    assert(ret == 0);
+    return fd;
+}
+
+// 等待pred成立，最多timeoutMs毫秒；返回pred最终的结果
+template <typename Pred>
+bool waitUntil(Pred pred, int timeoutMs = 5000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return pred();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// 在loop线程执行f并等待其返回；也用作屏障：此前投递到loop的任务都已执行
+template <typename F>
+void runInLoopAndWait(EventLoop* loop, F f) {
+    auto done = std::make_shared<std::promise<void>>();  // set_value返回前等待方可能已醒来，promise不能在栈上
+    std::future<void> finished = done->get_future();
+    loop->queueInLoop([&f, done]() {
+        f();
+        done->set_value();
+    });
+    finished.wait();
+}
+
+/**
+ * 在后台线程运行服务端：body在新线程中创建EventLoop和服务端，准备好（已开始监听）后调用run(&loop)。
+ * run通知构造函数返回，再进入loop.loop()；loop()返回后body继续执行清理并结束线程。
+ * 构造函数返回时loop()已可用，EventLoop指针经promise传递，不存在对裸指针的并发读写。
+ **/
+class ServerThread {
+public:
+    using Run = std::function<void(EventLoop*)>;
+
+    template <typename Body>
+    explicit ServerThread(Body body) {
+        std::future<EventLoop*> ready = started_.get_future();
+        thread_ = std::thread([this, body]() mutable {
+            body(Run([this](EventLoop* loop) {
+                started_.set_value(loop);
+                loop->loop();
+            }));
+        });
+        loop_ = ready.get();
+    }
+    ~ServerThread() { stop(); }
+
+    ServerThread(const ServerThread&) = delete;
+    ServerThread& operator=(const ServerThread&) = delete;
+
+    EventLoop* loop() const { return loop_; }
+    // 退出loop并等待线程结束
+    void stop() {
+        if (thread_.joinable()) {
+            loop_->quit();
+            thread_.join();
+        }
+    }
+    // 等待body自行结束（loop已在回调中quit）
+    void join() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+private:
+    std::promise<EventLoop*> started_;
+    EventLoop* loop_;
+    std::thread thread_;
+};
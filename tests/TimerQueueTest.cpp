@@ -0,0 +1,68 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "EventLoop.h"
+#include "TimeStamp.h"
+
+// 测试 runAfter 的执行顺序与 cancel
+void TestRunAfterAndCancel() {
+    EventLoop loop;
+    std::vector<int> order;
+
+    loop.runAfter(0.02, [&order]() { order.push_back(2); });
+    loop.runAfter(0.01, [&order]() { order.push_back(1); });
+    TimerId canceled = loop.runAfter(0.015, [&order]() { order.push_back(-1); });
+    loop.cancel(canceled);
+    loop.runAfter(0.05, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(order.size() == 2);
+    assert(order[0] == 1 && order[1] == 2);
+    std::cout << "TestRunAfterAndCancel passed!" << std::endl;
+}
+
+// 测试 runEvery 在回调中取消自身
+void TestRunEverySelfCancel() {
+    EventLoop loop;
+    int count = 0;
+    TimerId every;
+    every = loop.runEvery(0.005, [&]() {
+        if (++count == 3) {
+            loop.cancel(every);
+            loop.runAfter(0.03, [&loop]() { loop.quit(); });
+        }
+    });
+    loop.loop();
+
+    assert(count == 3);
+    std::cout << "TestRunEverySelfCancel passed!" << std::endl;
+}
+
+// 测试跨线程添加定时器，回调在loop线程中执行
+void TestCrossThreadAdd() {
+    EventLoop loop;
+    bool inLoopThread = false;
+    TimeStamp start = TimeStamp::now();
+    std::thread other([&]() {
+        loop.runAfter(0.01, [&]() {
+            inLoopThread = loop.isInLoopThread();
+            loop.quit();
+        });
+    });
+    loop.loop();
+    other.join();
+
+    assert(inLoopThread);
+    assert(timeDifference(TimeStamp::now(), start) >= 0.01);
+    std::cout << "TestCrossThreadAdd passed!" << std::endl;
+}
+
+int main() {
+    TestRunAfterAndCancel();
+    TestRunEverySelfCancel();
+    TestCrossThreadAdd();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <cassert>
+#include <iostream>
+
+#include "EventLoop.h"
+#include "TimeStamp.h"
+#include "TimingWheel.h"
+
+// 测试未touch的项按超时触发，超时超过一圈的项在正确的圈触发
+void TestExpire() {
+    EventLoop loop;
+    TimingWheel wheel(&loop, 0.01, 8);  // 一圈0.08秒
+    TimeStamp start = TimeStamp::now();
+    double shortFired = -1;
+    double longFired = -1;
+    wheel.add(0.05, [&]() { shortFired = timeDifference(TimeStamp::now(), start); });
+    wheel.add(0.2, [&]() { longFired = timeDifference(TimeStamp::now(), start); });
+    assert(wheel.size() == 2);
+    loop.runAfter(0.3, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(shortFired >= 0.05 && shortFired < 0.2);  // 最多晚两个tick，留出调度余量
+    assert(longFired >= 0.2);
+    assert(wheel.size() == 0);
+    std::cout << "TestExpire passed!" << std::endl;
+}
+
+// 测试touch推迟触发，停止touch后按最后一次touch计时
+void TestTouch() {
+    EventLoop loop;
+    TimingWheel wheel(&loop, 0.01, 8);
+    TimeStamp start = TimeStamp::now();
+    double fired = -1;
+    TimingWheel::EntryPtr entry = wheel.add(0.05, [&]() { fired = timeDifference(TimeStamp::now(), start); });
+    TimerId toucher = loop.runEvery(0.02, [&]() { entry->touch(); });
+    loop.runAfter(0.2, [&]() { loop.cancel(toucher); });
+    loop.runAfter(0.4, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(entry->expired());
+    assert(fired >= 0.2 + 0.05 - 0.02);  // 最后一次touch不早于停止前0.02秒
+    std::cout << "TestTouch passed!" << std::endl;
+}
+
+// 测试取消后不再回调，槽中的项随后被丢弃
+void TestCancel() {
+    EventLoop loop;
+    TimingWheel wheel(&loop, 0.01, 8);
+    bool fired = false;
+    TimingWheel::EntryPtr entry = wheel.add(0.03, [&]() { fired = true; });
+    entry->cancel();
+    loop.runAfter(0.1, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(!fired && !entry->expired());
+    assert(wheel.size() == 0);
+    std::cout << "TestCancel passed!" << std::endl;
+}
+
+// 测试槽中没有项时停止tick定时器，再次add时恢复计时
+void TestStopWhenEmpty() {
+    EventLoop loop;
+    TimingWheel wheel(&loop, 0.01, 8);
+    assert(!wheel.ticking());
+    bool fired = false;
+    wheel.add(0.02, [&]() { fired = true; });
+    assert(wheel.ticking());
+    uint64_t idleIterations = 0;
+    loop.runAfter(0.1, [&]() {
+        assert(fired && !wheel.ticking());
+        idleIterations = loop.metricsSnapshot().iterations;
+    });
+    loop.runAfter(0.3, [&loop]() { loop.quit(); });
+    loop.loop();
+    assert(loop.metricsSnapshot().iterations - idleIterations <= 2);  // 停止后只有quit定时器唤醒loop
+
+    // 停止期间tick计数暂停，新项仍按完整的超时计时
+    TimeStamp start = TimeStamp::now();
+    double refired = -1;
+    wheel.add(0.05, [&]() { refired = timeDifference(TimeStamp::now(), start); });
+    assert(wheel.ticking());
+    loop.runAfter(0.2, [&loop]() { loop.quit(); });
+    loop.loop();
+    assert(refired >= 0.05 && !wheel.ticking());
+    std::cout << "TestStopWhenEmpty passed!" << std::endl;
+}
+
+// 测试超时项比时间轮存活更久：时间轮析构后touch不访问已释放的时间轮
+void TestEntryOutlivesWheel() {
+    EventLoop loop;
+    TimingWheel::EntryPtr entry;
+    {
+        TimingWheel wheel(&loop, 0.01, 8);
+        entry = wheel.add(1.0, []() {});
+    }
+    entry->touch();
+    entry->cancel();
+    assert(!entry->expired());
+    std::cout << "TestEntryOutlivesWheel passed!" << std::endl;
+}
+
+int main() {
+    TestExpire();
+    TestTouch();
+    TestCancel();
+    TestStopWhenEmpty();
+    TestEntryOutlivesWheel();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -17,6 +17,7 @@ public:
     bool shutdownCalled{false};
     bool connected() const { return true; }
     void send(const std::string& data) { sent += data; }
+    void send(Buffer* buf) { sent += buf->retrieveAllAsString(); }
     void shutdown() { shutdownCalled = true; }
 };
 